@@ -20,6 +20,16 @@ ANDROID_SOURCES_C := \
 	../src/ivoice.c \
 	../src/psg.c \
 	../src/stic.c \
+	../src/state.c \
+	../src/rewind.c \
+	../src/crc.c \
+	../src/jlp.c \
+	../src/assets.c \
+	../src/log.c \
+	../src/perf.c \
+	../src/profile.c \
+	../src/trace.c \
+	../src/golden.c \
 	../src/stb_image_impl.c \
 	../src/deps/libretro-common/file/file_path.c \
 	../src/deps/libretro-common/compat/compat_posix_string.c \
@@ -35,6 +45,6 @@ include $(CLEAR_VARS)
 LOCAL_MODULE    := FreeIntvTSOverlay
 LOCAL_SRC_FILES := $(ANDROID_SOURCES_C)
 LOCAL_C_INCLUDES := $(INCLUDE_DIRS)
-LOCAL_CFLAGS    := -DANDROID -D__LIBRETRO__ -DHAVE_STRINGS_H -DRIGHTSHIFT_IS_SAR
+LOCAL_CFLAGS    := -DANDROID -D__LIBRETRO__ -DHAVE_STRINGS_H -DRIGHTSHIFT_IS_SAR -DHAVE_PTHREAD
 LOCAL_LDFLAGS   := -Wl,-version-script=$(CORE_DIR)/link.T
 include $(BUILD_SHARED_LIBRARY)
@@ -0,0 +1,404 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <dirent.h>
+#include <strings.h>
+#endif
+#include "stb_image.h"
+#include "assets.h"
+#include "crc.h"
+#include "file/file_path.h"
+#include "log.h"
+
+static struct assetBatch *pending = NULL; // requested, not started
+static struct assetBatch *done = NULL; // decoded, waiting for AssetsPoll
+
+// File to prefetch the successor of, scanned for only when nothing is pending
+static char prefetchPath[ASSET_PATH_MAX] = "";
+static int (*prefetchFill)(const char *next, struct assetBatch *batch) = NULL;
+
+static char cacheDir[ASSET_PATH_MAX] = "";
+
+#ifdef HAVE_PTHREAD
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static pthread_t worker;
+static int workerRunning = 0;
+static int workerQuit = 0;
+#endif
+
+void AssetsSetCacheDir(const char *dir)
+{
+	cacheDir[0] = '\0';
+	if (dir != NULL)
+		strncat(cacheDir, dir, sizeof(cacheDir) - 1);
+}
+
+static void cachePath(char *out, const char *path)
+{
+	char name[64];
+	snprintf(name, sizeof(name), "FreeIntv-asset-%08X.argb",
+		(unsigned int) crc32Buffer(0, (const unsigned char *) path, strlen(path)));
+	fill_pathname_join(out, cacheDir, name, ASSET_PATH_MAX);
+}
+
+// Load a cached decode if it matches the source file
+static int cacheLoad(const char *path, const struct assetCacheHeader *want, struct asset *out)
+{
+	char file[ASSET_PATH_MAX];
+	struct assetCacheHeader header;
+	size_t words;
+	FILE *fp;
+
+	cachePath(file, path);
+	if ((fp = fopen(file, "rb")) == NULL)
+		return 0;
+	if (fread(&header, sizeof(header), 1, fp) != 1 || header.magic != want->magic ||
+		header.version != want->version || header.mtime != want->mtime ||
+		header.size != want->size || header.pathCrc != want->pathCrc)
+	{
+		fclose(fp);
+		return 0;
+	}
+	words = (size_t) header.width * header.height;
+	out->pixels = (unsigned int *) malloc(words * sizeof(unsigned int));
+	if (out->pixels == NULL || fread(out->pixels, sizeof(unsigned int), words, fp) != words)
+	{
+		fclose(fp);
+		AssetFree(out);
+		return 0;
+	}
+	fclose(fp);
+	out->width = header.width;
+	out->height = header.height;
+	return 1;
+}
+
+static void cacheSave(const char *path, struct assetCacheHeader *header, const struct asset *asset)
+{
+	char file[ASSET_PATH_MAX];
+	size_t words = (size_t) asset->width * asset->height;
+	FILE *fp;
+
+	if (asset->width > 0xFFFF || asset->height > 0xFFFF)
+		return;
+	header->width = asset->width;
+	header->height = asset->height;
+	cachePath(file, path);
+	if ((fp = fopen(file, "wb")) == NULL)
+		return;
+	if (fwrite(header, sizeof(*header), 1, fp) != 1 ||
+		fwrite(asset->pixels, sizeof(unsigned int), words, fp) != words)
+	{
+		fclose(fp);
+		remove(file);
+		return;
+	}
+	fclose(fp);
+}
+
+static int decodeFile(const char *path, struct asset *out)
+{
+	int width, height, channels, i;
+	unsigned char *rgba, *p;
+	struct assetCacheHeader header;
+	struct stat st;
+
+	if (stat(path, &st) != 0)
+		return 0;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = ASSET_CACHE_MAGIC;
+	header.version = ASSET_CACHE_VERSION;
+	header.mtime = (int64_t) st.st_mtime;
+	header.size = (int64_t) st.st_size;
+	header.pathCrc = crc32Buffer(0, (const unsigned char *) path, strlen(path));
+	if (cacheDir[0] != '\0' && cacheLoad(path, &header, out))
+		return 1;
+
+	rgba = stbi_load(path, &width, &height, &channels, 4);
+	if (rgba == NULL)
+		return 0;
+
+	out->pixels = (unsigned int *) malloc((size_t) width * height * sizeof(unsigned int));
+	if (out->pixels != NULL)
+	{
+		// RGBA bytes to ARGB words
+		for (i = 0; i < width * height; i++)
+		{
+			p = rgba + i * 4;
+			out->pixels[i] = ((unsigned int) p[3] << 24) | (p[0] << 16) | (p[1] << 8) | p[2];
+		}
+		out->width = width;
+		out->height = height;
+		if (cacheDir[0] != '\0')
+			cacheSave(path, &header, out);
+	}
+	stbi_image_free(rgba);
+	return out->pixels != NULL;
+}
+
+int AssetDecode(const char *path, struct asset *out)
+{
+	out->pixels = NULL;
+	out->width = 0;
+	out->height = 0;
+	return decodeFile(path, out);
+}
+
+void AssetFree(struct asset *asset)
+{
+	free(asset->pixels);
+	asset->pixels = NULL;
+	asset->width = 0;
+	asset->height = 0;
+}
+
+void AssetsFreeBatch(struct assetBatch *batch)
+{
+	int i;
+	if (batch == NULL)
+		return;
+	for (i = 0; i < ASSET_SLOTS; i++)
+		AssetFree(&batch->result[i]);
+	free(batch);
+}
+
+static void decodeBatch(struct assetBatch *batch)
+{
+	int i, j;
+	for (i = 0; i < batch->count; i++)
+	{
+		for (j = 0; j < ASSET_FALLBACKS && batch->path[i][j][0] != '\0'; j++)
+		{
+			if (AssetDecode(batch->path[i][j], &batch->result[i]))
+			{
+				LogInfo("[FREEINTV] Loaded %s: %dx%d\n", batch->path[i][j],
+					batch->result[i].width, batch->result[i].height);
+				break;
+			}
+		}
+	}
+}
+
+#ifdef HAVE_PTHREAD
+// Find the file after path in its folder with the same extension, in
+// name order, wrapping around to the first one
+static int nextFile(const char *path, char *next)
+{
+	char dir[ASSET_PATH_MAX], first[ASSET_PATH_MAX] = "", after[ASSET_PATH_MAX] = "";
+	const char *name = path_basename(path);
+	const char *ext = path_get_extension(path);
+	struct dirent *entry;
+	DIR *dp;
+
+	if (name == NULL || ext == NULL || ext[0] == '\0')
+		return 0;
+	fill_pathname_basedir(dir, path, sizeof(dir));
+	if ((dp = opendir(dir[0] != '\0' ? dir : ".")) == NULL)
+		return 0;
+	while ((entry = readdir(dp)) != NULL)
+	{
+		const char *e = path_get_extension(entry->d_name);
+		if (e == NULL || strcasecmp(e, ext) != 0)
+			continue;
+		if (first[0] == '\0' || strcmp(entry->d_name, first) < 0)
+			snprintf(first, sizeof(first), "%s", entry->d_name);
+		if (strcmp(entry->d_name, name) > 0 && (after[0] == '\0' || strcmp(entry->d_name, after) < 0))
+			snprintf(after, sizeof(after), "%s", entry->d_name);
+	}
+	closedir(dp);
+
+	if (after[0] == '\0')
+		strcpy(after, first);
+	if (after[0] == '\0' || strcmp(after, name) == 0)
+		return 0; // alone in its folder
+	fill_pathname_join(next, dir, after, ASSET_PATH_MAX);
+	return 1;
+}
+
+// Idle work: the decoded pixels aren't wanted, only the disk cache entries
+static void prefetchNext(const char *path, int (*fill)(const char *, struct assetBatch *))
+{
+	char next[ASSET_PATH_MAX];
+	struct assetBatch *batch;
+
+	if (!nextFile(path, next))
+		return;
+	batch = (struct assetBatch *) calloc(1, sizeof(*batch));
+	if (batch == NULL)
+		return;
+	if (fill(next, batch))
+		decodeBatch(batch);
+	AssetsFreeBatch(batch);
+}
+
+static void *workerMain(void *arg)
+{
+	char path[ASSET_PATH_MAX];
+	int (*fill)(const char *, struct assetBatch *);
+	struct assetBatch *batch;
+
+	(void) arg;
+	pthread_mutex_lock(&lock);
+	while (!workerQuit)
+	{
+		if (pending == NULL && prefetchPath[0] == '\0')
+		{
+			pthread_cond_wait(&wake, &lock);
+			continue;
+		}
+		if (pending == NULL)
+		{
+			strcpy(path, prefetchPath);
+			fill = prefetchFill;
+			prefetchPath[0] = '\0';
+			pthread_mutex_unlock(&lock);
+			prefetchNext(path, fill);
+			pthread_mutex_lock(&lock);
+			continue;
+		}
+		batch = pending;
+		pending = NULL;
+
+		pthread_mutex_unlock(&lock);
+		decodeBatch(batch);
+		pthread_mutex_lock(&lock);
+
+		if (pending != NULL || workerQuit)
+		{
+			AssetsFreeBatch(batch); // superseded while decoding
+		}
+		else
+		{
+			AssetsFreeBatch(done);
+			done = batch;
+		}
+	}
+	pthread_mutex_unlock(&lock);
+	return NULL;
+}
+
+// Call with lock held
+static int startWorker(void)
+{
+	if (!workerRunning)
+		workerRunning = pthread_create(&worker, NULL, workerMain, NULL) == 0;
+	return workerRunning;
+}
+#endif
+
+static struct assetBatch *copyBatch(const struct assetBatch *batch)
+{
+	struct assetBatch *copy = (struct assetBatch *) malloc(sizeof(*copy));
+
+	if (copy != NULL)
+	{
+		memcpy(copy, batch, sizeof(*copy));
+		memset(copy->result, 0, sizeof(copy->result));
+	}
+	return copy;
+}
+
+void AssetsRequest(const struct assetBatch *batch)
+{
+	struct assetBatch *copy = copyBatch(batch);
+
+	if (copy == NULL)
+		return;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&lock);
+	if (startWorker())
+	{
+		AssetsFreeBatch(pending);
+		AssetsFreeBatch(done);
+		done = NULL;
+		pending = copy;
+		pthread_cond_signal(&wake);
+		pthread_mutex_unlock(&lock);
+		return;
+	}
+	pthread_mutex_unlock(&lock);
+#endif
+
+	// no worker, decode now
+	decodeBatch(copy);
+	AssetsFreeBatch(done);
+	done = copy;
+}
+
+void AssetsPrefetchNext(const char *path, int (*fill)(const char *next, struct assetBatch *batch))
+{
+#ifdef HAVE_PTHREAD
+	if (path == NULL || fill == NULL || cacheDir[0] == '\0')
+		return; // nowhere to keep the result
+	pthread_mutex_lock(&lock);
+	if (startWorker())
+	{
+		prefetchPath[0] = '\0';
+		strncat(prefetchPath, path, sizeof(prefetchPath) - 1);
+		prefetchFill = fill;
+		pthread_cond_signal(&wake);
+	}
+	pthread_mutex_unlock(&lock);
+#else
+	(void) path; // scanning and decoding inline would only stall the caller
+	(void) fill;
+#endif
+}
+
+struct assetBatch *AssetsPoll(void)
+{
+	struct assetBatch *batch;
+
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&lock);
+#endif
+	batch = done;
+	done = NULL;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&lock);
+#endif
+	return batch;
+}
+
+void AssetsShutdown(void)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&lock);
+	workerQuit = 1;
+	pthread_cond_signal(&wake);
+	pthread_mutex_unlock(&lock);
+	if (workerRunning)
+		pthread_join(worker, NULL);
+	workerRunning = 0;
+	workerQuit = 0;
+#endif
+	AssetsFreeBatch(pending);
+	AssetsFreeBatch(done);
+	pending = NULL;
+	done = NULL;
+	prefetchPath[0] = '\0';
+	prefetchFill = NULL;
+}
@@ -0,0 +1,93 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// Overlay image assets, decoded to ARGB off the game thread.  A batch
+// names up to ASSET_SLOTS images, each with a chain of fallback paths.
+// With HAVE_PTHREAD the batch is decoded by a worker thread; without it,
+// AssetsRequest decodes inline.  The frontend polls once per frame and
+// takes the finished batch.  A new request replaces one that hasn't
+// been collected yet.
+//
+// Decoded images are cached in the save directory as
+// FreeIntv-asset-<crc32 of path>.argb: a struct assetCacheHeader
+// followed by the ARGB words, so later launches skip the PNG decoder.
+// An entry is used only if the source path, size and mtime all match.
+// The worker can also fill that cache ahead of time, while it is idle,
+// with images of the file likely to be loaded next (AssetsPrefetchNext),
+// so that load skips the decoder too.  Nothing is kept in memory: the
+// frontend deinitializes the core between games.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSET_SLOTS     8
+#define ASSET_FALLBACKS 3
+#define ASSET_PATH_MAX  1024
+
+struct asset
+{
+	unsigned int *pixels; // ARGB, NULL if nothing in the chain decoded
+	int width;
+	int height;
+};
+
+#define ASSET_CACHE_MAGIC   0x43414946 // "FIAC"
+#define ASSET_CACHE_VERSION 1
+
+struct assetCacheHeader // host byte order, 32 bytes so the pixels stay aligned
+{
+	uint32_t magic;
+	uint32_t version;
+	int64_t mtime; // of the source image
+	int64_t size;
+	uint32_t pathCrc; // crc32 of the source path
+	uint16_t width;
+	uint16_t height;
+};
+
+struct assetBatch
+{
+	int count; // slots used
+	char path[ASSET_SLOTS][ASSET_FALLBACKS][ASSET_PATH_MAX]; // "" ends a chain
+	struct asset result[ASSET_SLOTS];
+};
+
+void AssetsSetCacheDir(const char *dir); // NULL or "" disables the disk cache
+
+int AssetDecode(const char *path, struct asset *out); // decode one image now, returns 1 on success
+
+void AssetFree(struct asset *asset);
+
+void AssetsRequest(const struct assetBatch *batch); // copies the batch
+
+// When the worker is idle, find the file after path in its folder (same
+// extension, name order, wrapping around), let fill name images for it
+// and decode them into the disk cache.  The folder scan and fill both run
+// on the worker; fill returns 0 to skip.  Needs the worker and a cache
+// directory, otherwise it does nothing.
+void AssetsPrefetchNext(const char *path, int (*fill)(const char *next, struct assetBatch *batch));
+
+struct assetBatch *AssetsPoll(void); // the finished batch, or NULL
+
+void AssetsFreeBatch(struct assetBatch *batch); // frees pixels the caller didn't take
+
+void AssetsShutdown(void); // stop the worker and drop any pending batch
+
+#endif
@@ -17,101 +17,131 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <file/file_path.h>
+#include <retro_miscellaneous.h>
 #include "memory.h"
 #include "cart.h"
 #include "osd.h"
+#include "crc.h"
+#include "jlp.h"
+#include "log.h"
 
 int isIntellicart(void);
 int loadIntellicart(void);
-int isROM(void);
-int loadROM(void);
+static void copyWords(int p, int count, int adr);
 int getLoadMethod(void);
-void load0(void);
-void load1(void);
-void load2(void);
-void load3(void);
-void load4(void);
-void load5(void);
-void load6(void);
-void load7(void);
-void load8(void);
-void load9(void);
-
-int data[0x20000]; // rom data loaded from file
+static int loadConfigFile(const char *path);
+static int loadBuiltinMap(int method);
+
+unsigned char *data = NULL; // rom data loaded from file
 
 int size = 0; // size of file read
 
 int pos = 0; // current position in data
 
+static uint32_t crc = 0; // crc32 of rom data
+
+static uint16_t *pages[16][16]; // page flipped rom, by 4K segment and page
+
+int CartECS = 0; // cartridge needs the ECS
+
+struct cartdbEntry
+{
+	uint32_t crc;
+	int size;
+	int method; // memory map, -1 if unknown
+	int flags;
+	const char *name;
+};
+
+#define CARTDB_ECS 1
+
+#include "cartdb.h"
+
+uint32_t CartCRC(void)
+{
+	return crc;
+}
+
 int LoadCart(const char *path)
 {
-	unsigned char word[1];
 	FILE *fp;
+	long len;
+	int i;
 
-    printf("[INFO] [FREEINTV] Attempting to load cartridge ROM from: %s\n", path);		
+    LogInfo("[FREEINTV] Attempting to load cartridge ROM from: %s\n", path);		
 
 	size = 0;
 
+	free(data);
+	data = NULL;
+	for(i=0; i<16*16; i++)
+	{
+		free(pages[i/16][i%16]);
+		pages[i/16][i%16] = NULL;
+	}
+	JLPInit(0, 0);
+	CartECS = 0;
+
 	if((fp = fopen(path,"rb"))!=NULL)
 	{
-		while(fread(word,sizeof(word),1,fp) && size<0x20000)
+		fseek(fp, 0, SEEK_END);
+		len = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+		// padded so the fingerprint and readWord never run past the end
+		if(len<=0 || (data = calloc(len + 256, 1))==NULL || fread(data, 1, len, fp)!=(size_t)len)
 		{
-			data[size] = word[0];
-			size++;
+			LogError("[FREEINTV] Cartridge load error reading %ld bytes\n", len);
+			fclose(fp);
+			return 0;
 		}
-        fclose(fp);
-        if (feof(fp))
-        {
-            printf("[INFO] [FREEINTV] Successful cartridge load: EOF indicator set\n");
-        }
-        if (ferror(fp))
-        {
-            printf("[ERROR] [FREEINTV] Cartridge load error indicator set\n");
-        }
-        
+		fclose(fp);
+		size = len;
+		crc = crc32Buffer(0, data, size);
+		LogInfo("[FREEINTV] Successful cartridge load: %i bytes, CRC32 %08X\n", size, (unsigned int)crc);
+
 		OSD_drawText(8, 7, "SIZE:");
 		OSD_drawInt(14, 7, size, 10);
 
         if(isIntellicart()) // intellicart format
         {
 			OSD_drawText(8, 8, "INTELLICART");
-            printf("[INFO] [FREEINTV] Intellicart cartridge format detected\n");		
+			if(data[0]!=0xA8)
+			{
+				OSD_drawText(8, 9, "MISSING A8!");
+			}
+            LogInfo("[FREEINTV] Intellicart cartridge format detected\n");		
             return loadIntellicart();
         }
+        else if(data[0]==0xA8)
+        {
+			OSD_drawText(8, 8, "INTELLICART");
+			OSD_drawText(8, 10, "BAD SIZE");
+			LogError("[FREEINTV] Corrupt .rom image: segments don't match file size\n");
+			return 0;
+        }
         else
         {
-			if(isROM())
+			// a .cfg next to the rom overrides the database
+			if(loadConfigFile(path)>0)
 			{
-				OSD_drawText(8, 8, "INTELLICART");
-				OSD_drawText(8, 9, "MISSING A8!");
-				printf("[INFO] [FREEINTV] Possible Intellicart cartridge format detected\n");
-				return loadROM();
+				return 1;
 			}
-			else
+			// check cartinfo database for load method
+			LogInfo("[FREEINTV] Raw ROM image. Determining load method via database.\n");		
+			if(!loadBuiltinMap(getLoadMethod()))
 			{
-				// check cartinfo database for load method
-				printf("[INFO] [FREEINTV] Raw ROM image. Determining load method via database.\n");		
-				switch(getLoadMethod())
-				{
-						case 0: load0(); break;
-						case 1: load1(); break;
-						case 2: load2(); break;
-						case 3: load3(); break;
-						case 4: load4(); break;
-						case 5: load5(); break;
-						case 6: load6(); break;
-						case 7: load7(); break;
-						case 8: load8(); break;
-						case 9: load9(); break;
-						default: printf("[INFO] [FREEINTV] No database match. Using default cartridge memory map.\n"); load0();
-				}
+				LogInfo("[FREEINTV] No database match. Using default cartridge memory map.\n");
+				loadBuiltinMap(0);
 			}
         }
         return 1; // loaded okay
 	}
     else
     {
-        printf("[ERROR] [FREEINTV] Failed to load cartridge ROM file.\n");		
+        LogError("[FREEINTV] Failed to load cartridge ROM file.\n");		
         return 0;
     }
 }
@@ -126,121 +156,364 @@ int readWord(void)
 	return val;
 }
 
-void loadRange(int start, int stop)
+// http://spatula-city.org/~im14u2c/intv/jzintv-1.0-beta3/doc/rom_fmt/IntellicartManual.booklet.pdf
+//
+// .rom layout: magic, segment count and its 1's complement, then for each
+// segment the high bytes of its start and stop addresses, the data words
+// and a CRC-16 of all of it.  The image ends with the enable tables: 16
+// bytes of attribute nibbles and 32 bytes of fine address ranges for the
+// 32 2K pages, plus a CRC-16 of both.
+#define ROM_TABLE_SIZE 50
+
+#define ROM_READ   0x1
+#define ROM_WRITE  0x2
+#define ROM_NARROW 0x4
+#define ROM_BANKSW 0x8
+
+// walk the segment headers, returns offset of the enable tables or -1
+static int romTables(void)
 {
-	while(start<=stop && pos<size) // load segment
+	int i, words;
+	int p = 3;
+
+	if(size<3 || data[1]!=(data[2]^0xFF))
+	{
+		return -1;
+	}
+	for(i=0; i<data[1]; i++)
 	{
-		Memory[start] = readWord();
-		start++;
+		if(p+2>size || data[p+1]<data[p]) { return -1; }
+		words = (data[p+1] - data[p] + 1) * 0x100;
+		p += 2 + words*2 + 2;
 	}
+	return (p==size || p+ROM_TABLE_SIZE==size) ? p : -1;
 }
 
-// http://spatula-city.org/~im14u2c/intv/jzintv-1.0-beta3/doc/rom_fmt/IntellicartManual.booklet.pdf
-int isIntellicart() // check for intellicart format rom
+static int romCRC(int p, int len)
 {
-	// check magic number (used for intellicart baud rate detection)
-	return (data[0]==0xA8); 
+	return crc16Buffer(0xFFFF, &data[p], len) == ((data[p+len]<<8) | data[p+len+1]);
 }
 
-int isROM() // some Intellicart roms don't start with A8 for no apparent reason
+int isIntellicart() // check for intellicart format rom
 {
-	// the third byte should be the 1's compliment of the second byte
-	return data[1] == (data[2]^0xFF);
+	// Intellicart roms start with A8 (used for intellicart baud rate
+	// detection), but some don't, so go by the segment layout
+	return romTables()>=0;
 }
 
 int loadIntellicart() // load intellicart format rom
 {
-	int start;
-	int stop;
-	int i, t;
-	int segments;
+	int table = romTables();
+	int i, p, words;
+	int page, attr, first, last;
 
-	pos = 0;
-	segments = readWord() & 0xFF; // number of non-contiguous rom segments (drop magic number)
-	pos++; // 1's compliment of segments (ignore)
+	// check everything before touching memory
+	for(i=0, p=3; i<data[1]; i++)
+	{
+		words = (data[p+1] - data[p] + 1) * 0x100;
+		if(!romCRC(p, 2 + words*2))
+		{
+			LogError("[FREEINTV] Corrupt .rom image: CRC mismatch in segment %i ($%02X00-$%02XFF)\n", i, data[p], data[p+1]);
+			OSD_drawText(8, 10, "BAD CRC");
+			return 0;
+		}
+		p += 2 + words*2 + 2;
+	}
+	if(table<size && !romCRC(table, ROM_TABLE_SIZE-2))
+	{
+		LogError("[FREEINTV] Corrupt .rom image: CRC mismatch in enable tables\n");
+		OSD_drawText(8, 10, "BAD CRC");
+		return 0;
+	}
+
+	for(i=0, p=3; i<data[1]; i++)
+	{
+		words = (data[p+1] - data[p] + 1) * 0x100;
+		copyWords(p+2, words, data[p]<<8);
+		if(table==size)
+		{
+			MemoryMapRange(data[p]<<8, (data[p+1]<<8) | 0xFF, MEM_ROM);
+		}
+		p += 2 + words*2 + 2;
+	}
+	if(table==size)
+	{
+		LogInfo("[FREEINTV] No enable tables, segments mapped as ROM\n");
+		return 1;
+	}
 
-	for(i=0; i<segments; i++)
+	for(page=0; page<32; page++)
 	{
-		t = readWord(); // high bytes of segment start and stop addresses
-		start = t & 0xFF00;
-		stop = ((t<<8) & 0xFF00) | 0xFF;
-		loadRange(start, stop);
-		t = readWord(); // CRC for segment (ignored)
+		attr = (data[table + page/2] >> ((page&1)*4)) & 0xF;
+		first = (page<<11) | (((data[table + 16 + page] >> 4) & 7) << 8);
+		last = (page<<11) | ((data[table + 16 + page] & 7) << 8) | 0xFF;
+		if(attr & ROM_BANKSW)
+		{
+			LogInfo("[FREEINTV] Bank switching not supported: $%04X-$%04X\n", first, last);
+		}
+		if(attr & ROM_WRITE)
+		{
+			MemoryMapRange(first, last, (attr & ROM_NARROW) ? MEM_RAM8 : MEM_RAM);
+		}
+		else if(attr & ROM_READ)
+		{
+			MemoryMapRange(first, last, MEM_ROM);
+		}
 	}
-	// Enable tables (ignored)
 	return 1;
 }
 
-int loadROM() // load ROM formatted cart
-{
-	return loadIntellicart();
-}
-
+// Built-in memory maps, written in jzIntv .cfg syntax and indexed by
+// the load method in the cartridge database.  Based on
 // http://atariage.com/forums/topic/203179-config-files-to-use-with-various-intellivision-titles/
-
-void load0() // default - handles majority of carts
+static const char *builtinMaps[] =
 {
-	loadRange(0x5000, 0x6FFF);
-	loadRange(0xD000, 0xDFFF);
-	loadRange(0xF000, 0xFFFF);
-}
+	// 0 - default, handles majority of carts
+	"[mapping]\n$0000 - $1FFF = $5000\n$2000 - $2FFF = $D000\n$3000 - $3FFF = $F000\n",
+	// 1
+	"[mapping]\n$0000 - $1FFF = $5000\n$2000 - $4FFF = $D000\n",
+	// 2
+	"[mapping]\n$0000 - $1FFF = $5000\n$2000 - $4FFF = $9000\n$5000 - $5FFF = $D000\n",
+	// 3
+	"[mapping]\n$0000 - $1FFF = $5000\n$2000 - $3FFF = $9000\n$4000 - $4FFF = $D000\n$5000 - $5FFF = $F000\n",
+	// 4
+	"[mapping]\n$0000 - $1FFF = $5000\n[memattr]\n$D000 - $D3FF = RAM 8\n",
+	// 5
+	"[mapping]\n$0000 - $2FFF = $5000\n$3000 - $5FFF = $9000\n",
+	// 6
+	"[mapping]\n$0000 - $1FFF = $6000\n",
+	// 7
+	"[mapping]\n$0000 - $1FFF = $4800\n",
+	// 8
+	"[mapping]\n$0000 - $0FFF = $5000\n$1000 - $1FFF = $7000\n",
+	// 9
+	"[mapping]\n$0000 - $1FFF = $5000\n$2000 - $3FFF = $9000\n$4000 - $4FFF = $D000\n$5000 - $5FFF = $F000\n"
+	"[memattr]\n$8800 - $8FFF = RAM 8\n",
+};
+#define BUILTIN_MAPS (sizeof(builtinMaps) / sizeof(builtinMaps[0]))
 
-void load1()
+// copy count words from byte offset p of the rom image to adr
+static void copyWords(int p, int count, int adr)
 {
-	loadRange(0x5000, 0x6FFF);
-	loadRange(0xD000, 0xFFFF);
+	pos = p;
+	while(count-- > 0)
+	{
+		Memory[adr++ & 0xFFFF] = readWord();
+	}
 }
 
-void load2()
+// words first-last of the rom image that are actually in the file
+static int wordsAvailable(int first, int last)
 {
-	loadRange(0x5000, 0x6FFF);
-	loadRange(0x9000, 0xBFFF);
-	loadRange(0xD000, 0xDFFF);
+	int count = last - first + 1;
+	if(count > (size - first*2 + 1) / 2)
+	{
+		count = (size - first*2 + 1) / 2;
+	}
+	if(count > 0x10000)
+	{
+		count = 0x10000;
+	}
+	return count;
 }
 
-void load3()
+// copy words first-last of the rom image to adr, returns words copied
+static int mapRange(int first, int last, int adr, int attr)
 {
-	loadRange(0x5000, 0x6FFF);
-	loadRange(0x9000, 0xAFFF);
-	loadRange(0xD000, 0xDFFF);
-	loadRange(0xF000, 0xFFFF);
+	int count = wordsAvailable(first, last);
+	if(count<=0)
+	{
+		return 0;
+	}
+	copyWords(first*2, count, adr);
+	if(attr>=0)
+	{
+		MemoryMapRange(adr, adr + count - 1, attr);
+	}
+	return count;
 }
 
-void load4()
+// copy words first-last of the rom image to page of the segments at adr,
+// returns words copied
+static int mapPage(int first, int last, int adr, int page)
 {
-	loadRange(0x5000, 0x6FFF);
-	// [memattr] $D000 - $D3FF = RAM 8 // automatic 
+	int count = wordsAvailable(first, last);
+	int i, segment, j;
+
+	pos = first * 2;
+	for(i=0; i<count; i++, adr++)
+	{
+		segment = (adr>>12) & 0xF;
+		if(pages[segment][page]==NULL)
+		{
+			if((pages[segment][page] = malloc(0x1000 * sizeof(uint16_t)))==NULL)
+			{
+				return i;
+			}
+			for(j=0; j<0x1000; j++) { pages[segment][page][j] = 0xFFFF; }
+			MemoryAddPage(segment, page, pages[segment][page]);
+			MemoryMapRange(segment<<12, (segment<<12) | 0xFFF, MEM_ROM);
+		}
+		pages[segment][page][adr & 0xFFF] = readWord();
+	}
+	return count;
 }
 
-void load5()
+static const char *skipSpace(const char *s)
 {
-	loadRange(0x5000, 0x7FFF);
-	loadRange(0x9000, 0xBFFF);
+	while(*s==' ' || *s=='\t') { s++; }
+	return s;
 }
 
-void load6()
+// parse "$first - $last =" at the start of a line
+static const char *parseRange(const char *s, int *first, int *last)
 {
-	loadRange(0x6000, 0x7FFF);
+	char *end;
+	s = skipSpace(s);
+	if(*s!='$') { return NULL; }
+	*first = strtol(s+1, &end, 16);
+	s = skipSpace(end);
+	if(*s!='-') { return NULL; }
+	s = skipSpace(s+1);
+	if(*s!='$') { return NULL; }
+	*last = strtol(s+1, &end, 16);
+	s = skipSpace(end);
+	if(*s!='=' || *first>*last) { return NULL; }
+	return skipSpace(s+1);
 }
 
-void load7()
+enum { CFG_OTHER, CFG_MAPPING, CFG_PRELOAD, CFG_MEMATTR, CFG_BANKSWITCH, CFG_VARS };
+
+// Apply a jzIntv .cfg memory map to the loaded rom image.  Handles
+// [mapping] (rom, PAGE n for ECS-style page flipping), [preload]
+// (initialized ram), [memattr] (ram) and the jlp/jlpflash/ecs [vars];
+// other sections are skipped.  Returns the number of words mapped.
+static int loadConfig(const char *text)
 {
-	loadRange(0x4800, 0x67FF);
+	char line[256];
+	const char *s;
+	char *end;
+	int section = CFG_OTHER;
+	int first, last, adr, len, attr;
+	int mapped = 0;
+	int jlp = 0, jlpflash = 0;
+
+	while(*text)
+	{
+		// copy one line, dropping the comment
+		len = strcspn(text, "\r\n");
+		snprintf(line, sizeof(line), "%.*s", len < (int)sizeof(line) ? len : (int)sizeof(line)-1, text);
+		text += len;
+		text += strspn(text, "\r\n");
+		line[strcspn(line, ";")] = '\0';
+
+		s = skipSpace(line);
+		if(*s=='[')
+		{
+			section = CFG_OTHER;
+			if(strncmp(s, "[mapping]", 9)==0) { section = CFG_MAPPING; }
+			if(strncmp(s, "[preload]", 9)==0) { section = CFG_PRELOAD; }
+			if(strncmp(s, "[memattr]", 9)==0) { section = CFG_MEMATTR; }
+			if(strncmp(s, "[bankswitch]", 12)==0) { section = CFG_BANKSWITCH; }
+			if(strncmp(s, "[vars]", 6)==0) { section = CFG_VARS; }
+			continue;
+		}
+		if(section==CFG_OTHER || *s=='\0')
+		{
+			continue;
+		}
+		if(section==CFG_VARS)
+		{
+			// name = value
+			len = strcspn(s, " \t=");
+			end = (char *) skipSpace(s + len);
+			if(*end=='=')
+			{
+				if(len==3 && strncmp(s, "jlp", 3)==0) { jlp = strtol(end+1, NULL, 0); }
+				if(len==8 && strncmp(s, "jlpflash", 8)==0) { jlpflash = strtol(end+1, NULL, 0); }
+				if(len==3 && strncmp(s, "ecs", 3)==0) { CartECS = strtol(end+1, NULL, 0) != 0; }
+			}
+			continue;
+		}
+		if(section==CFG_BANKSWITCH)
+		{
+			LogInfo("[FREEINTV] Cartridge config: bank switching not supported: %s\n", s);
+			continue;
+		}
+		if((s = parseRange(s, &first, &last))==NULL)
+		{
+			LogError("[FREEINTV] Cartridge config: bad line: %s\n", line);
+			continue;
+		}
+		switch(section)
+		{
+			case CFG_MAPPING:
+			case CFG_PRELOAD:
+				if(*s!='$') { break; }
+				adr = strtol(s+1, &end, 16);
+				s = skipSpace(end);
+				if(strncmp(s, "PAGE", 4)==0 && section==CFG_MAPPING)
+				{
+					mapped += mapPage(first, last, adr, strtol(s+4, NULL, 16) & 0xF);
+					break;
+				}
+				mapped += mapRange(first, last, adr, section==CFG_MAPPING ? MEM_ROM : -1);
+				break;
+			case CFG_MEMATTR:
+				attr = MEM_RAM;
+				if(strncmp(s, "RAM", 3)!=0 && strncmp(s, "WOM", 3)!=0) { break; }
+				if(last>0xFFFF) { break; }
+				if(strtol(s+3, NULL, 10)==8) { attr = MEM_RAM8; }
+				for(adr=first; adr<=last; adr++) { Memory[adr] = 0; }
+				MemoryMapRange(first, last, attr);
+				break;
+		}
+	}
+	if(jlp || jlpflash)
+	{
+		JLPInit(jlp, jlpflash);
+	}
+	return mapped;
 }
 
-void load8()
+static int loadBuiltinMap(int method)
 {
-	loadRange(0x5000, 0x5FFF);
-	loadRange(0x7000, 0x7FFF);
+	if(method<0 || method>=(int)BUILTIN_MAPS)
+	{
+		return 0;
+	}
+	loadConfig(builtinMaps[method]);
+	return 1;
 }
 
-void load9()
+// load <rom>.cfg from next to the rom, returns words mapped
+static int loadConfigFile(const char *path)
 {
-	loadRange(0x5000, 0x6FFF);
-	loadRange(0x9000, 0xAFFF);
-	loadRange(0xD000, 0xDFFF);
-	loadRange(0xF000, 0xFFFF);
-	// [memattr] $8800 - $8FFF = RAM 8 // is this automatic too??? 
+	char cfgPath[PATH_MAX_LENGTH];
+	char *text;
+	FILE *fp;
+	long len;
+	int mapped = 0;
+
+	fill_pathname(cfgPath, path, ".cfg", sizeof(cfgPath));
+	if((fp = fopen(cfgPath, "rb"))==NULL)
+	{
+		return 0;
+	}
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if(len>0 && (text = calloc(len + 1, 1))!=NULL)
+	{
+		if(fread(text, 1, len, fp)==(size_t)len)
+		{
+			LogInfo("[FREEINTV] Using cartridge config: %s\n", cfgPath);
+			mapped = loadConfig(text);
+		}
+		free(text);
+	}
+	fclose(fp);
+	return mapped;
 }
 
 int fingerprints[] =
@@ -448,19 +721,39 @@ int getLoadMethod() // lazy, but it works
 {
 	int i;
 	int fingerprint = 0;
+	const struct cartdbEntry *entry;
+
+	// look up crc in the cartridge database first
+	for(i=crc&(CARTDB_BUCKETS-1); cartdbIndex[i]>=0; i=(i+1)&(CARTDB_BUCKETS-1))
+	{
+		entry = &cartdb[cartdbIndex[i]];
+		if(entry->crc==crc && entry->size==size)
+		{
+			LogInfo("[FREEINTV] Cartridge database match: %s\n", entry->name);
+			CartECS = (entry->flags & CARTDB_ECS) != 0;
+			if(entry->method>=0)
+			{
+				LogInfo("[FREEINTV] Cartridge database match: memory map %i\n", entry->method);
+				return entry->method;
+			}
+			break;
+		}
+	}
+
+	// fall back to fingerprint for dumps not in the database
 	// find fingerprint
 	for(i=0; i<256; i++)
 	{
 		fingerprint = fingerprint + data[i];
 	}
-	printf("[INFO] [FREEINTV] Cartridge fingerprint code: %i\n", fingerprint);
+	LogInfo("[FREEINTV] Cartridge fingerprint code: %i\n", fingerprint);
 	
 	// find load method
 	for (i=0; i<380; i+=2)
 	{
 		if(fingerprint==fingerprints[i])
 		{
-			printf("[INFO] [FREEINTV] Cartridge database match: memory map %i\n", fingerprints[i+1]);
+			LogInfo("[FREEINTV] Cartridge database match: memory map %i\n", fingerprints[i+1]);
 			if(fingerprint==11349)
 			{
 				// Baseball or MTE Test Cart?
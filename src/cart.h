@@ -18,6 +18,12 @@
 	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <stdint.h>
+
 int LoadCart(const char *path);
 
+extern int CartECS; // cartridge needs the ECS
+
+uint32_t CartCRC(void); // crc32 of the loaded rom file
+
 #endif
\ No newline at end of file
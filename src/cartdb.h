@@ -0,0 +1,232 @@
+/* Generated by tools/mkcartdb.py from the TOSEC DATs in metadata/ - do not edit */
+
+#define CARTDB_BUCKETS 512
+
+static const struct cartdbEntry cartdb[] =
+{
+{0xd7c78754,  16384,  0, 0, "4-TRIS (2000)(Zbiciak, Joseph)(PD)"},
+{0xa60e25fc,   8192,  0, 0, "ABPA Backgammon (1978)(Mattel)"},
+{0xf8b1f2b7,  16384,  0, 0, "Advanced Dungeons and Dragons (1982)(Mattel)"},
+{0x16c3b62f,  16384,  0, 0, "Advanced Dungeons and Dragons - Treasure of Tarmin (1982)(Mattel)"},
+{0x11c3bcfa,  16384,  0, 0, "Adventure -AD&D- Cloudy Mountain (1982)(Mattel)"},
+{0x2c668249,   8192,  0, 0, "Air Strike (1982)(Mattel)"},
+{0xb45633cf,  24576,  0, 0, "All-Star Major League Baseball (1983)(Mattel)"},
+{0x6f91fbc1,   8192,  0, 0, "Armor Battle (1978)(Mattel)"},
+{0xfab2992c,   8192,  0, 0, "Astrosmash (1981)(Mattel)"},
+{0x00be8bba,   8192, -1, 0, "Astrosmash - Meteor (1981)(Mattel)"},
+{0x13ff363c,  16384,  7, 0, "Atlantis (1981)(Imagic)"},
+{0xb35c1101,   8192,  0, 0, "Auto Racing (1979)(Mattel)"},
+{0x8ad19ab3,  24576,  0, 0, "B-17 Bomber (1981)(Mattel)"},
+{0xdab36628,   8192,  0, 0, "Baseball (1978)(Mattel)"},
+{0x12bbf7ad,  16896, -1, 0, "Baseball (1978)(Mattel)[a]"},
+{0xeaf650cc,  16384,  0, 0, "BeamRider (1983)(Activision)"},
+{0xc047d487,  16384,  7, 0, "Beauty and the Beast (1982)(Imagic)"},
+{0xb03f739b,  16384,  0, 0, "Blockade Runner (1983)(Interphase)"},
+{0x515e1d7e,  32768,  2, 0, "Body Slam - Super Pro Wrestling (1988)(Intv Corp)"},
+{0x32697b72,  24576,  0, 0, "Bomb Squad (1982)(Mattel)"},
+{0x18e08520,   1028,  0, 0, "Bouncing Pixels (1999)(-)(PD)"},
+{0xab87c16f,   8192,  0, 0, "Boxing (1980)(Mattel)"},
+{0x9f85015b,   8192,  0, 0, "Brickout! (1981)(Mattel)"},
+{0x999cceed,  32768,  0, 0, "Bump 'N' Jump (1983)(Mattel)"},
+{0x43806375,  16384,  0, 0, "BurgerTime! (1982)(Mattel)"},
+{0xfa492bbd,  16384,  0, 0, "Buzz Bombers (1982)(Mattel)"},
+{0x43870908,   8192,  0, 0, "Carnival (1982)(Coleco-CBS)"},
+{0x7a31a650,  14848, -1, 0, "Castle (demo-playable) (2003)(Chevallier, Arnauld)"},
+{0xd5363b8c,  16384,  6, 0, "Centipede (1983)(Atarisoft)"},
+{0x4cc46a04,  32768,  1, 0, "Championship Tennis (1985)(Mattel)"},
+{0x36e1d858,   8192,  0, 0, "Checkers (1979)(Mattel)"},
+{0x0bf464c6,  32768,  2, 0, "Chip Shot - Super Pro Golf (1987)(Intv Corp)"},
+{0x3289c8ba,  32768,  2, 0, "Commando (1987)(Mattel)"},
+{0x4b23a757,  24576,  5, 0, "Congo Bongo (1983)(Sega)"},
+{0xe1ee408f,   8192,  0, 0, "Crazy Clones (1981)(Mattel)"},
+{0x6802b191,  32768,  2, 0, "Deep Pockets - Super Pro Pool and Billiards (1990)(Realtime)"},
+{0xd8f99aa2,  24576,  5, 0, "Defender (1983)(Atarisoft)"},
+{0x5e6a8cd8,  16384,  7, 0, "Demon Attack (1982)(Imagic)"},
+{0x159af7f7,  32768,  5, 0, "Dig Dug (1987)(Intv Corp)"},
+{0x13ee56f1,  32768,  2, 0, "Diner (1987)(Intv Corp)"},
+{0xc30f61c0,   8192,  0, 0, "Donkey Kong (1982)(Coleco)"},
+{0x6df61a9f,  16384,  0, 0, "Donkey Kong Jr (1982)(Coleco)"},
+{0x84bedcc1,  16384,  0, 0, "Dracula (1982)(Imagic)"},
+{0xaf8718a1,   8192,  0, 0, "Dragonfire (1982)(Imagic)"},
+{0xbf4d0e9b,  16384,  0, 0, "Dreadnaught Factor, The (1983)(Activision)(proto)"},
+{0x3b99b889,  16384,  0, 0, "Dreadnaught Factor, The (1983)(Activision)"},
+{0xf3df94e0,  32768,  0, 0, "Duncan's Thin Ice (1983)(Mattel)"},
+{0x20ace89d,   8192,  0, 0, "Easter Eggs (1981)(Mattel)"},
+{0x4221ede7,  16384,  0, 0, "Fathom (1983)(Imagic)"},
+{0x37222762,   8192,  0, 0, "Frog Bog (1982)(Mattel)"},
+{0xd27495e9,   8192,  0, 0, "Frogger (1983)(Parker Bros)"},
+{0xdbca82c5,  16384,  0, 0, "Go For the Gold (1981)(Mattel)"},
+{0x291ac826,   8192,  0, 0, "Grid Shock (1982)(Mattel)"},
+{0x4b8c5932,   8192,  0, 0, "Happy Trails (1983)(Activision)"},
+{0xb6a3d4de,  16384,  0, 0, "Hard Hat (1979)(Mattel)"},
+{0xb5c7f25d,   8192,  0, 0, "Horse Racing (1980)(Mattel)"},
+{0xff83ff80,  49152,  2, 0, "Hover Force (1986)(Intv Corp)"},
+{0xa3147630,   8192,  0, 0, "Hypnotic Lights (1981)(Mattel)"},
+{0x4f3e3f69,  16384,  0, 0, "Ice Trek (1983)(Imagic)"},
+{0x42d74bec,   5632, -1, 0, "IntvWolf - Beta 1 (2003)(Chevallier, Arnauld)(beta)"},
+{0xdad3590e,   6656, -1, 0, "IntvWolf - Beta 1 (2003)(Chevallier, Arnauld)(beta)[a]"},
+{0x9f6fc91c,  19968, -1, 0, "KChess v1.0 (2003)(Chevallier, Arnauld)"},
+{0x4422868e,  32768,  1, 0, "King of the Mountain (1982)(Mattel)"},
+{0x8c9819a2,  16384,  0, 0, "Kool-Aid Man (1983)(Mattel)"},
+{0xa6840736,  16384,  0, 0, "Lady Bug (1983)(Coleco)"},
+{0x3825c25b,  16384,  4, 0, "Land Battle (1982)(Mattel)"},
+{0x604611c0,   8192,  0, 0, "Las Vegas Blackjack and Poker (1979)(Mattel)"},
+{0x48d74d3c,   8192,  0, 0, "Las Vegas Roulette (1979)(Mattel)"},
+{0xe00d1399,  16384,  0, 0, "Lock 'N' Chase (1982)(Mattel)"},
+{0x04977992,  12288, -1, 0, "Lock 'N' Chase (1982)(Mattel)[a2]"},
+{0x5c7e9848,  16384, -1, 0, "Lock 'N' Chase (1982)(Mattel)[a]"},
+{0x6b6e80ee,  16384,  0, 0, "Loco-Motion (1982)(Mattel)"},
+{0x7ab439b0,   4608, -1, 0, "Mad Drivin' v0.1 (demo) (2003)(Chevallier, Arnauld)"},
+{0x64555742,   5120, -1, 0, "Mad Drivin' v0.2 (demo) (2003)(Chevallier, Arnauld)"},
+{0xb8fb9325,   8192, -1, 0, "Mad Drivin' v0.3 (demo) (2004)(Chevallier, Arnauld)"},
+{0xa3939afe,   9728, -1, 0, "Mad Drivin' v0.4 (demo-playable) (2004)(Chevallier, Arnauld)"},
+{0x573b9b6d,  32768,  0, 0, "Masters of the Universe - The Power of He-Man! (1983)(Mattel)"},
+{0xe806ad91,  16384,  7, 0, "Microsurgeon (1982)(Imagic)"},
+{0x9d57498f,  24576,  0, CARTDB_ECS, "Mind Strike! (1982)(Mattel)(ECS)"},
+{0xa9f1d874,  16384,  0, 0, "Minehunter (2004)(Kinnen, Ryan)"},
+{0x05a06292,  14848,  0, 0, "Minehunter (2004-03-20)(Kinnen, Ryan)(PD)"},
+{0xbd731e3c,  16384,  0, 0, "Minotaur (1981)(Mattel)"},
+{0x2f9c93fc,  16384, -1, 0, "Minotaur - Treasure of Tarmin (1982)(Mattel)[h BSR]"},
+{0x11fb9974,  16384,  0, 0, "Mission X (1982)(Mattel)"},
+{0x5f6e1af6,  16384,  0, 0, "Motocross (1982)(Mattel)"},
+{0x6b5ea9c4,  16384,  0, 0, "Mountain Madness - Super Pro Skiing (1987)(Intv Corp)"},
+{0x598662f2,   8192,  0, 0, "Mouse Trap (1982)(Coleco)"},
+{0x0b50a367,  24576,  0, CARTDB_ECS, "Mr. Basic Meets Bits 'N Bytes (1983)(Mattel)(ECS)"},
+{0xdbab54ca,   8192,  0, 0, "NASL Soccer (1979)(Mattel)"},
+{0x81e7fb8c,   8192,  0, 0, "NBA Basketball (1978)(Mattel)"},
+{0x4b91cf16,   8192,  0, 0, "NFL Football (1978)(Mattel)"},
+{0x76564a13,   8192,  0, 0, "NHL Hockey (1979)(Mattel)"},
+{0x7334cd44,   8192,  0, 0, "Night Stalker (1982)(Mattel)"},
+{0x5ee2cc2a,  16384,  0, 0, "Nova Blast (1983)(Imagic)"},
+{0xe5d1a8d2,  32768,  0, 0, "Number Jumble (1983)(Mattel)"},
+{0x169e3584,   8192,  0, 0, "PBA Bowling (1980)(Mattel)"},
+{0xff87faec,   8192,  0, 0, "PGA Golf (1979)(Mattel)"},
+{0xa21c31c3,  24576,  5, 0, "Pac-Man (1983)(Atarisoft)"},
+{0x6e4e8eb4,  24576,  5, 0, "Pac-Man (1983)(Intv Corp)"},
+{0x73774506,   4096, -1, 0, "Pac-Man (2010)(DZ-Jay)[toggle test]"},
+{0x2127ce9c,   4096,  5, 0, "Pac-Man (2010-07-07)(DZ-Jay)"},
+{0xfcea4d71,   4096,  5, 0, "Pac-Man (2010-07-08)(DZ-Jay)"},
+{0x405c2d4b,   4608, -1, 0, "Pac-Man (2010-08-08)(DZ-Jay)[Input Test]"},
+{0x094ceaf9,   4096,  5, 0, "Pac-Man (2010-09-06)(DZ-Jay)"},
+{0x4a28bed1,   4608,  5, 0, "Pac-Man (2010-09-19)(DZ-Jay)"},
+{0x1ea0c935,   4608, -1, 0, "Pac-Man (2010-09-19)(DZ-Jay)[a slow]"},
+{0x2f04a4e0,   5120,  5, 0, "Pac-Man (2010-09-26)(DZ-Jay)"},
+{0x11958f4b,   5632,  5, 0, "Pac-Man (2010-09-28)(DZ-Jay)"},
+{0xf37bf8a6,   5632,  5, 0, "Pac-Man (2010-10-03)(DZ-Jay)"},
+{0x3b4dd3ad,   6656,  5, 0, "Pac-Man (2010-10-29)(DZ-Jay)"},
+{0x7ccf1567,   6656,  5, 0, "Pac-Man (2010-11-01)(DZ-Jay)"},
+{0x0725c7c5,   6656,  5, 0, "Pac-Man (2010-11-03)(DZ-Jay)"},
+{0xb3366f31,   6656,  5, 0, "Pac-Man (2010-11-06)(DZ-Jay)"},
+{0x3e184875,   7168,  5, 0, "Pac-Man (2010-11-09)(DZ-Jay)"},
+{0xd7c5849c,  24576,  0, 0, "Pinball (1981)(Mattel)"},
+{0x9c75efcc,   8192,  0, 0, "Pitfall! (1982)(Activision)"},
+{0xbb939881,  32768,  2, 0, "Pole Position (1986)(Intv Corp)"},
+{0xa982e8d5,   4096,  0, 0, "Pong (1999)(-)(PD)"},
+{0xc51464e0,  16384,  0, 0, "Popeye (1983)(Parker Bros)"},
+{0xd8c9856a,  16384,  0, 0, "Q-bert (1983)(Parker Bros)"},
+{0xc7bb1b0e,   8192,  0, 0, "Reversi (1984)(Mattel)"},
+{0x8910c37a,  16384,  0, 0, "River Raid (1983)(Activision)"},
+{0x95466ad3,  16384,  0, 0, "River Raid v1 (1983)(Activision)(proto)"},
+{0x7473916d,   8192,  0, 0, "Robot Rubble (1983)(Activision)(proto)"},
+{0xe7576c1f,   8192, -1, 0, "Robot Rubble (1983)(Activision)(proto)[a]"},
+{0x1682d0b4,   8194, -1, 0, "Robot Rubble (1983)(Activision)(proto)[o]"},
+{0xa5e28783,   8192,  0, 0, "Robot Rubble v2 (1983)(Activision)(proto)"},
+{0xdcf4b15d,  16384,  0, 0, "Royal Dealer (1981)(Mattel)"},
+{0x0458a491,  12288, -1, 0, "Royal Dealer (1981)(Mattel)[a]"},
+{0x47aa7977,  16384,  0, 0, "Safecracker (1983)(Imagic)"},
+{0xe221808c,   8192,  0, 0, "Santa's Helper (1983)(Mattel)"},
+{0xe9e3f60d,  16384,  0, 0, "Scooby Doo's Maze Chase (1983)(Mattel)"},
+{0x99ae29a9,   8192,  0, 0, "Sea Battle (1980)(Mattel)"},
+{0xe0f0d3da,  16384,  0, 0, "Sewer Sam (1983)(Interphase)"},
+{0x2a4c761d,  16384,  0, 0, "Shark! Shark! (1982)(Mattel)"},
+{0xff7cb79e,   8192,  0, 0, "Sharp Shot (1982)(Mattel)"},
+{0x2119310b,   5120, -1, 0, "Singed Earth (2003)(SDK-1600)"},
+{0x800b572f,  32768,  2, 0, "Slam Dunk - Super Pro Basketball (1987)(Intv Corp)"},
+{0xba68ff28,  16384,  0, 0, "Slap Shot - Super Pro Hockey (1987)(Intv Corp)"},
+{0x8f959a6e,   8192,  0, 0, "Snafu (1981)(Mattel)"},
+{0xe8b8eba5,   8192,  0, 0, "Space Armada (1981)(Mattel)"},
+{0xf95504e0,   8192,  0, 0, "Space Battle (1979)(Mattel)"},
+{0xf8ef3e5a,  16384,  0, 0, "Space Cadet (1982)(Mattel)"},
+{0x39d3b895,   8192,  0, 0, "Space Hawk (1981)(Mattel)"},
+{0x3784dc52,  16384,  0, 0, "Space Spartans (1981)(Mattel)"},
+{0xa95021fc,  32768,  2, 0, "Spiker! - Super Pro Volleyball (1988)(Intv Corp)"},
+{0xb745c1ca,  32768,  2, 0, "Stadium Mud Buggies (1988)(Intv Corp)"},
+{0x2deacd15,   8192,  0, 0, "Stampede (1982)(Activision)"},
+{0x72e11fca,   8192,  0, 0, "Star Strike (1981)(Mattel)"},
+{0xd5b0135a,   8192,  0, 0, "Star Wars - The Empire Strikes Back (1983)(Parker Bros)"},
+{0x4830f720,   8192,  0, 0, "Street (1981)(Mattel)"},
+{0x3d9949ea,  16384,  0, 0, "Sub Hunt (1981)(Mattel)"},
+{0xed67bb5a,   4608, -1, 0, "Sudoku (19xx)(-)"},
+{0x8f7d3069,  16386,  0, 0, "Super Cobra (1983)(Parker Brothers)"},
+{0x7c32c9b8,  16384, -1, 0, "Super Cobra (1983)(Parker Brothers)[a2]"},
+{0x82cc04f6,  16896, -1, 0, "Super Cobra (1983)(Parker Brothers)[a]"},
+{0xbab638f2,  16384,  0, 0, "Super Masters! (1982)(Mattel)"},
+{0x16bfb8eb,  32768,  2, 0, "Super Pro Decathlon (1988)(Intv Corp)"},
+{0x32076e9d,  32768,  2, 0, "Super Pro Football (1986)(Intv Corp)"},
+{0x51b82eb7,  32768,  0, 0, "Super Soccer (1983)(Mattel)"},
+{0x15e88fce,  16384,  0, 0, "Swords and Serpents (1982)(Imagic)"},
+{0xca447bbd,   8192,  0, 0, "TRON - Deadly Discs (1981)(Mattel)"},
+{0xcdc14ed8,   8192,  0, 0, "TRON - Deadly Discs - Deadly Dogs (1987)(Intv Corp)"},
+{0x7a558cf5,  16384,  0, 0, "TRON - Maze-A-Tron (1981)(Mattel)"},
+{0x07fb9435,  24576,  0, 0, "TRON - Solar Sailer (1982)(Mattel)"},
+{0x1ecdd51b,  10752,  0, 0, "Tag-Along Todd v3.13 (20xx)(Z., Joe - H., David)(beta)"},
+{0x1f584a69,   8192,  0, 0, "Takeover (1982)(Mattel)"},
+{0x03e9e62e,   8192,  0, 0, "Tennis (1980)(Mattel)"},
+{0xd43fd410,  16384,  0, 0, "Tetris (2000)(Zbiciak, Joseph)(PD)"},
+{0xc1f1ca74,  32768,  0, 0, "Thunder Castle (1982)(Mattel)"},
+{0xd1d352a0,  49152,  3, 0, "Tower of Doom (1986)(Intv Corp)"},
+{0x1ac989e2,   8192,  0, 0, "Triple Action (1981)(Mattel)"},
+{0x095638c0,  45058,  9, 0, "Triple Challenge (1986)(Intv Corp)"},
+{0x6f23a741,  16384,  0, 0, "Tropical Trouble (1982)(Imagic)"},
+{0x734f3260,  16384,  0, 0, "Truckin' (1983)(Imagic)"},
+{0x275f3512,  16384,  0, 0, "Turbo (1983)(Coleco)"},
+{0x6fa698b3,  16384,  0, 0, "Tutankham (1983)(Parker Bros)"},
+{0xf093e801,   8192,  0, 0, "U.S. Ski Team Skiing (1980)(Mattel)"},
+{0x752fd927,  16384,  4, 0, "USCF Chess (1981)(Mattel)"},
+{0xd5977aba,   6144, -1, 0, "Untitled Game - Interactive Blob Art (2003)(Kinnen, Ryan)(PD)(beta)"},
+{0xec710041,   6201, -1, 0, "Untitled Game - Interactive Blob Art (2003)(Kinnen, Ryan)(PD)(beta)[a]"},
+{0xf9e0789e,   8192,  0, 0, "Utopia (1981)(Mattel)"},
+{0xa4a20354,  24576,  0, 0, "Vectron (1982)(Mattel)"},
+{0x6efa67b2,  16384,  0, 0, "Venture (1982)(Coleco)"},
+{0xf1ed7d27,  16384,  0, 0, "White Water! (1983)(Imagic)"},
+{0x15d9d27a,  32768,  0, 0, "World Cup Football (1985)(Nice Ideas)"},
+{0xa12c27e1,  40960,  1, CARTDB_ECS, "World Series Major League Baseball (1983)(Mattel)(ECS)"},
+{0x24b667b9,   8192,  0, 0, "Worm Whomper (1983)(Activision)"},
+{0x15c65dc5,  16384,  0, 0, "Zaxxon (1982)(Coleco)"},
+};
+
+static const short cartdbIndex[CARTDB_BUCKETS] =
+{
+ -1, 177,  -1,  -1,  29,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 131,  -1,  -1,
+168,  -1,  -1,  91,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 134,  -1, 124,
+ -1,  -1,  -1,  -1,  -1,  -1,  52,  -1,  13,  -1,  93,  -1,  -1,  -1, 167,   3,
+ 57,  -1,  -1,  -1,  -1, 164,  -1,  -1,  -1,  -1,  -1,  -1,  10,  81,  -1,  -1,
+ -1, 180,  -1,  -1,  -1,  -1,  -1,  -1,  70,   5,  -1,  -1,  -1,  -1,  -1,  -1,
+ 27,  -1, 144,  -1,  -1,  -1,  -1,  -1,  30,  -1, 142,  65,  -1,  55,  -1,  -1,
+174,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 153, 166,  -1,  -1,  -1, 139,  -1,
+ -1,  -1,  -1,  -1,  79, 113, 169,  -1,  -1,  -1, 185,  -1,  -1,  -1,  -1,  -1,
+ -1, 116,  -1,  -1,  -1,  -1,  -1,  16,  -1,  45,  -1,  -1, 130,  -1,  62,  34,
+ -1, 128,  80,  -1,  -1, 143,  -1,  -1,  -1,  -1,  -1,  44, 100,  47, 114,  41,
+158,  43,  36, 170, 181,  -1, 108,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,
+ -1,  -1,  -1,  12,  98, 125, 176,   2, 159,  -1,  32, 179,  -1,  -1,  -1,  -1,
+172,  42,  -1,  -1,  -1,  51,  31,  -1,  -1,  -1,  88,  -1,  15,  -1,  -1,  -1,
+ -1, 104,  94, 122,  -1, 117,  -1,  -1,  37, 162,  -1,  -1,  -1,  -1,  54,  -1,
+ 46, 106, 118, 141,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 157,  96,  23,  71,  -1,
+ -1,  39,  86, 156,  -1, 163,  84, 155,  -1, 103,   4,  -1,  -1,  -1,  75,  -1,
+ -1,  11,  -1,  -1,  -1,  -1,  99,  -1,  26,  -1,  -1, 136,  -1,  -1,  60, 120,
+ -1,  -1, 175,  -1,  -1, 147,  90,  -1,  -1,  -1,  -1, 165,  61,  -1,  -1,  -1,
+ 20, 150,  -1,  -1,  -1,  74,  -1, 178, 138, 184,  -1,  -1,   8,  -1,  -1, 137,
+ -1, 112,  53,  -1,  -1, 105,  64,  -1,  -1,  -1,  -1,  -1,  67,  -1,  -1,  -1,
+ -1, 173,  73,  -1,  92,  -1,  -1,  -1,  -1,  -1,  -1, 102, 107,  -1,  -1,  -1,
+ -1,  -1,  -1,  -1,   0, 182,  -1,  33,  -1,  -1, 149,  22, 152, 127,  -1,  -1,
+ -1,  -1,  49,  -1,  -1,  -1,  -1,  87, 110,  58, 119,  -1,  -1,  76, 123,  21,
+ -1, 101,  19,  -1,  83,  24,  -1, 129,  -1,  -1, 121,  -1,  -1,  -1,  18,  -1,
+ 56,  -1,  -1, 126,  95,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  28,  89,  -1,  78,
+ -1,  35,  69,  77,  -1,  -1,  -1,  -1,  -1,  68,  -1,  17,  -1,  -1, 135,  -1,
+ -1,  -1,  63,  -1,  -1, 140,  -1,  -1,  -1, 132,  -1,  -1,  -1,  14, 109,  -1,
+ 72,  -1, 183,  -1,  -1,  -1,  -1,  -1, 154, 187,   9,  -1,  -1,  25, 161,  -1,
+ 40,   7,  66,  97,  85, 111, 188,  -1,  -1,  -1, 146, 148, 115,  -1, 160,   6,
+ -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1,  -1, 133,  -1,  -1,  -1,  -1,  -1,
+ -1, 186, 171,  -1,  -1,  -1,  -1,  48,  -1,  50, 151,  -1,  59,  -1,  -1,  -1,
+ -1,  -1,  -1,  -1,  -1,  -1,  -1,  38,  -1,  -1,  -1,  -1,   1,  82, 145,  -1,
+};
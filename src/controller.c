@@ -87,8 +87,9 @@ void setControllerInput(int player, int state)
 	// For K_9 (0x24): written value = (0x24 ^ 0xFF) & 0xFF = 0xDB
 }
 
-int getControllerState(int joypad[], int player)
+int getControllerState(const struct joypadState *pad, int player)
 {
+	int b = pad->buttons;
 	// converts joypad input for use by system  
 	int Lx = 0; // left analog X
 	int Ly = 0; // left analog Y
@@ -99,26 +100,26 @@ int getControllerState(int joypad[], int player)
 
 	int state = 0; //0xFF;
 
-	if(joypad[0]!=0) { state |= D_N; } // 0xFB - Up
-	if(joypad[1]!=0) { state |= D_S; } // 0xFE - Down
-	if(joypad[2]!=0) { state |= D_W; } // 0xF7 - Left
-	if(joypad[3]!=0) { state |= D_E; } // 0xFD - Right
+	if(b & J_UP) { state |= D_N; } // 0xFB - Up
+	if(b & J_DOWN) { state |= D_S; } // 0xFE - Down
+	if(b & J_LEFT) { state |= D_W; } // 0xF7 - Left
+	if(b & J_RIGHT) { state |= D_E; } // 0xFD - Right
 
-	if(joypad[0]!=0 && joypad[2]!=0) { state |= D_NW; } // 0xE3 - Up+Left
-	if(joypad[0]!=0 && joypad[3]!=0) { state |= D_NE; } // 0xE9 - Up+Right
-	if(joypad[1]!=0 && joypad[2]!=0) { state |= D_SW; } // 0x36 - Down+Left
-	if(joypad[1]!=0 && joypad[3]!=0) { state |= D_SE; } // 0x3C - Down+Right
+	if((b & (J_UP|J_LEFT))==(J_UP|J_LEFT)) { state |= D_NW; } // 0xE3 - Up+Left
+	if((b & (J_UP|J_RIGHT))==(J_UP|J_RIGHT)) { state |= D_NE; } // 0xE9 - Up+Right
+	if((b & (J_DOWN|J_LEFT))==(J_DOWN|J_LEFT)) { state |= D_SW; } // 0x36 - Down+Left
+	if((b & (J_DOWN|J_RIGHT))==(J_DOWN|J_RIGHT)) { state |= D_SE; } // 0x3C - Down+Right
 
-	if(joypad[7]!=0) { state |= B_TOP; } // 0x5F - Button Top
-	if(joypad[4]!=0) { state |= B_LEFT; } // 0x9F - Button Left
-	if(joypad[5]!=0) { state |= B_RIGHT; } // 0x3F - Button Right
+	if(b & J_Y) { state |= B_TOP; } // 0x5F - Button Top
+	if(b & J_A) { state |= B_LEFT; } // 0x9F - Button Left
+	if(b & J_B) { state |= B_RIGHT; } // 0x3F - Button Right
 
-	if(joypad[6]!=0) { state |= getQuickKeypadState(player); }
+	if(b & J_X) { state |= getQuickKeypadState(player); }
 
 	/* Analog Controls for 16-way disc control */
 
-	Lx = joypad[14] / 8192;
-	Ly = joypad[15] / 8192;
+	Lx = pad->analog[0] / 8192;
+	Ly = pad->analog[1] / 8192;
 	if(Lx != 0 || Ly != 0)
 	{
 		// find angle 
@@ -132,8 +133,8 @@ int getControllerState(int joypad[], int player)
 	}
 
 	// Right-analog to keypad mapping (for Tron Deadly Discs)
-	Rx = joypad[16] / 8192;
-	Ry = joypad[17] / 8192;
+	Rx = pad->analog[2] / 8192;
+	Ry = pad->analog[3] / 8192;
 	if(Rx != 0 || Ry != 0)
 	{
 		// find angle 
@@ -147,12 +148,12 @@ int getControllerState(int joypad[], int player)
 	}
 
 	// Thumbsticks for Keypad 0/5
-	if(joypad[18]!=0) { state |= K_0; } // 0x48 - Keypad 0
-	if(joypad[19]!=0) { state |= K_5; } // 0x42 - Keypad 5
+	if(b & J_L3) { state |= K_0; } // 0x48 - Keypad 0
+	if(b & J_R3) { state |= K_5; } // 0x42 - Keypad 5
 
 	// L/R triggers for Keypad Enter/Clear
-	if(joypad[12]!=0) { state |= K_C; } // 0x88 - Keypad Clear
-	if(joypad[13]!=0) { state |= K_E; } // 0x28 - Keypad Enter
+	if(b & J_L2) { state |= K_C; } // 0x88 - Keypad Clear
+	if(b & J_R2) { state |= K_E; } // 0x28 - Keypad Enter
 
 	return state;
 }
@@ -204,23 +205,23 @@ int miniKeypadImage[1053] =
 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
 };
 
-int getKeypadState(int player, int joypad[], int joypre[])
+int getKeypadState(int player, const struct joypadState *pad)
 {
 	int cursorX = cursor[player*2];
 	int cursorY = cursor[player*2+1];
 	int state = 0x0;
 
 	// move cursor only on button down
-	if(joypre[0]==0 && joypad[0]!=0) { cursorY--; if(cursorY<0) { cursorY = 3; } } // up
-	if(joypre[1]==0 && joypad[1]!=0) { cursorY++; if(cursorY>3) { cursorY = 0; } } // down
-	if(joypre[2]==0 && joypad[2]!=0) { cursorX--; if(cursorX<0) { cursorX = 2; } } // left
-	if(joypre[3]==0 && joypad[3]!=0) { cursorX++; if(cursorX>2) { cursorX = 0; } } // right
+	if(pad->pressed & J_UP) { cursorY--; if(cursorY<0) { cursorY = 3; } } // up
+	if(pad->pressed & J_DOWN) { cursorY++; if(cursorY>3) { cursorY = 0; } } // down
+	if(pad->pressed & J_LEFT) { cursorX--; if(cursorX<0) { cursorX = 2; } } // left
+	if(pad->pressed & J_RIGHT) { cursorX++; if(cursorX>2) { cursorX = 0; } } // right
 
 	cursor[player*2] = cursorX;
 	cursor[player*2+1] = cursorY;
 
 	// let any face button press keypad
-	if(joypad[4]!=0 || joypad[5]!=0 || joypad[6]!=0 || joypad[7]!=0)
+	if(pad->buttons & (J_A|J_B|J_X|J_Y))
 	{
 		state = keypadStates[(cursorY*3)+cursorX];
 	}
@@ -36,11 +36,37 @@ extern int keypadStates[];
 #define K_C 0x88  // * (asterisk/star)
 #define K_E 0x28  // # (hash/pound)
 
+// Joypad buttons, one bit each in RETRO_DEVICE_ID_JOYPAD order so a
+// RETRO_DEVICE_ID_JOYPAD_MASK read can be stored as is
+#define J_B      0x0001
+#define J_Y      0x0002
+#define J_SELECT 0x0004
+#define J_START  0x0008
+#define J_UP     0x0010
+#define J_DOWN   0x0020
+#define J_LEFT   0x0040
+#define J_RIGHT  0x0080
+#define J_A      0x0100
+#define J_X      0x0200
+#define J_L      0x0400
+#define J_R      0x0800
+#define J_L2     0x1000
+#define J_R2     0x2000
+#define J_L3     0x4000
+#define J_R3     0x8000
+
+struct joypadState
+{
+	int buttons; // J_ bits held
+	int pressed; // J_ bits that went down since the previous read
+	int analog[4]; // left x, left y, right x, right y
+};
+
 void controllerInit(void);
 
-int getControllerState(int joypad[], int player);
+int getControllerState(const struct joypadState *pad, int player);
 
-int getKeypadState(int player, int joypad[], int joypre[]);
+int getKeypadState(int player, const struct joypadState *pad);
 
 void setControllerInput(int player, int state); 
 
@@ -20,6 +20,9 @@
 #include "intv.h"
 #include "memory.h"
 #include "cp1610.h"
+#include "log.h"
+#include "profile.h"
+#include "trace.h"
 
 // http://wiki.intellivision.us/index.php?title=CP1610#Instruction_Set
 // http://spatula-city.org/~im14u2c/chips/GICP1600.pdf
@@ -168,40 +171,17 @@ int CP1610Tick(int debug)
 	// execute one instruction //
 	int sdbd = Flag_DoubleByteData;
 
-	unsigned int instruction = readMem(R[PC]);
+	unsigned int pc = R[PC];
+	unsigned int instruction = readMem(pc);
 
 	int ticks = 0;
-#if 0
-    static int global_ticks = 0;
-#endif
 
-    // DEBUG
-#if 0
-    {
-        FILE *debug_file;
-        
-        fprintf(stdout, "%04x:[%03x%c %04x %04x %04x %04x %04x %04x %04x %s %c%c%c%c%c%c\n", R[7], instruction, instruction > 0x03ff ? 'X' : ']', R[0], R[1], R[2], R[3], R[4], R[5], R[6], Nmemonic[instruction], Flag_Sign ? 'S' : '-', Flag_Carry ? 'C' : '-', Flag_Overflow ? 'O' : '-', Flag_Zero ? 'Z' : '-', Flag_InteruptEnable ? 'I' : '-', Flag_DoubleByteData ? 'D' : '-');
-    }
-#endif
-#if 0   // Debug output compatible with JZINTV for comparison purposes
-    {
-        FILE *debug_file;
-        
-        fprintf(debug_file, " %04X %04X %04X %04X %04X %04X %04X %04X %c%c%c%c%c%c%c%c %20s %d\n", R[0], R[1], R[2], R[3], R[4], R[5], R[6], R[7],
-            Flag_Sign ? 'S' : '-',
-            Flag_Zero ? 'Z' : '-',
-            Flag_Overflow ? 'O' : '-',
-            Flag_Carry ? 'C' : '-',
-            Flag_InteruptEnable ? 'I' : '-',
-            Flag_DoubleByteData ? 'D' : '-',
-            Interuptable[instruction] ? 'i' : '-',
-            SR1 > 0 ? 'q' : '-' , Nmemonic[instruction], global_ticks);
-    }
-#endif
+	if (TraceEnabled)
+		TraceInstruction(instruction);
     
     if(instruction > 0x03FF)
 	{
-		printf("[ERROR][FREEINT] Bad opcode: %i\n", instruction);
+		LogError("[FREEINTV] Bad opcode: %i\n", instruction);
 	        // bad OpCode, Halt //
 		return 0;
 	}
@@ -225,16 +205,17 @@ int CP1610Tick(int debug)
 		}
 	}
 
-#if 0
-    global_ticks += ticks;
-#endif
+	if (TraceEnabled)
+		TraceTicks(ticks);
+	if (ProfileEnabled)
+		ProfileCount(pc, instruction, ticks);
 	return ticks;
 }
 
 int HLT(int v)
 {
     // Halt Instruction found! //
-    printf("\n\n[ERROR] [FREEINTV] HALT!\n");
+    LogError("[FREEINTV] HALT!\n");
   
     R[PC]--; // Repeat instruction forever instead of exiting without warning
     return 0;
@@ -37,4 +37,7 @@ void CP1610Reset(void); // reset cpu
 
 int CP1610Tick(int debug); // execute a single instruction, return cycles used
 
+extern const char *Nmemonic[0x400]; // opcode names
+extern int Interuptable[0x400]; // 1 if an interrupt may be taken before the opcode
+
 #endif
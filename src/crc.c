@@ -0,0 +1,70 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "crc.h"
+
+static uint32_t crc32Table[256];
+static uint16_t crc16Table[256];
+
+static void crc32Init(void)
+{
+	uint32_t i, j, c;
+	for(i=0; i<256; i++)
+	{
+		c = i;
+		for(j=0; j<8; j++)
+		{
+			c = (c>>1) ^ (0xEDB88320 & (0-(c&1)));
+		}
+		crc32Table[i] = c;
+	}
+}
+
+static void crc16Init(void)
+{
+	uint16_t i, j, c;
+	for(i=0; i<256; i++)
+	{
+		c = i<<8;
+		for(j=0; j<8; j++)
+		{
+			c = (c<<1) ^ (0x1021 & (0-(c>>15)));
+		}
+		crc16Table[i] = c;
+	}
+}
+
+uint32_t crc32Buffer(uint32_t crc, const unsigned char *buf, size_t len)
+{
+	if(crc32Table[1]==0) { crc32Init(); }
+	crc = ~crc;
+	while(len--)
+	{
+		crc = crc32Table[(crc ^ *buf++) & 0xFF] ^ (crc>>8);
+	}
+	return ~crc;
+}
+
+uint16_t crc16Buffer(uint16_t crc, const unsigned char *buf, size_t len)
+{
+	if(crc16Table[1]==0) { crc16Init(); }
+	while(len--)
+	{
+		crc = crc16Table[((crc>>8) ^ *buf++) & 0xFF] ^ (crc<<8);
+	}
+	return crc;
+}
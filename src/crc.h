@@ -0,0 +1,28 @@
+#ifndef CRC_H
+#define CRC_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+uint32_t crc32Buffer(uint32_t crc, const unsigned char *buf, size_t len); // start with crc=0
+
+// CRC-16-CCITT (polynomial 0x1021, MSB first) as used by .rom files
+uint16_t crc16Buffer(uint16_t crc, const unsigned char *buf, size_t len); // start with crc=0xFFFF
+
+#endif
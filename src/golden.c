@@ -0,0 +1,200 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "golden.h"
+#include "log.h"
+
+int GoldenMode = GOLDEN_OFF;
+
+struct goldenFrame
+{
+	unsigned int frame;
+	unsigned int ports[2];
+	uint64_t video;
+	uint64_t audio;
+};
+
+static FILE *goldenFile = NULL;
+static unsigned int frames = 0; // frames recorded or checked
+static uint64_t audioHash;
+static struct goldenFrame expected;
+static int videoBad, audioBad; // frames that differ
+static unsigned int firstVideo, firstAudio;
+
+// v1 hashed the resampled output
+#define GOLDEN_HEADER "# FreeIntv golden frames v2"
+
+#define FNV_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+static void start(int mode, FILE *fp)
+{
+	goldenFile = fp;
+	frames = 0;
+	audioHash = FNV_BASIS;
+	videoBad = audioBad = 0;
+	GoldenMode = mode;
+}
+
+int GoldenRecord(const char *path)
+{
+	FILE *fp;
+
+	GoldenStop();
+	if ((fp = fopen(path, "w")) == NULL)
+	{
+		LogError("[FREEINTV] Golden: can't create %s\n", path);
+		return 0;
+	}
+	fprintf(fp, "%s: frame, ports 1FE 1FF, video hash, audio hash\n", GOLDEN_HEADER);
+	start(GOLDEN_RECORD, fp);
+	LogInfo("[FREEINTV] Golden: recording to %s\n", path);
+	return 1;
+}
+
+// next recorded frame, 0 at the end of the file
+static int readExpected(void)
+{
+	char line[128];
+	unsigned long long video, audio;
+
+	while (fgets(line, sizeof(line), goldenFile) != NULL)
+	{
+		if (line[0] == '#')
+			continue;
+		if (sscanf(line, "%u %x %x %llx %llx", &expected.frame, &expected.ports[0], &expected.ports[1], &video, &audio) != 5)
+			continue;
+		expected.video = video;
+		expected.audio = audio;
+		return 1;
+	}
+	return 0;
+}
+
+int GoldenVerify(const char *path)
+{
+	char line[128];
+	FILE *fp;
+
+	GoldenStop();
+	if ((fp = fopen(path, "r")) == NULL)
+		return 0;
+	if (fgets(line, sizeof(line), fp) == NULL || strncmp(line, GOLDEN_HEADER, strlen(GOLDEN_HEADER)) != 0)
+	{
+		LogError("[FREEINTV] Golden: %s is from another version, record it again\n", path);
+		fclose(fp);
+		return 0;
+	}
+	start(GOLDEN_VERIFY, fp);
+	if (!readExpected())
+	{
+		LogError("[FREEINTV] Golden: no frames in %s\n", path);
+		GoldenStop();
+		return 0;
+	}
+	LogInfo("[FREEINTV] Golden: verifying against %s\n", path);
+	return 1;
+}
+
+void GoldenStop(void)
+{
+	if (goldenFile == NULL)
+		return;
+	fclose(goldenFile);
+	goldenFile = NULL;
+
+	if (GoldenMode == GOLDEN_RECORD)
+		LogInfo("[FREEINTV] Golden: recorded %u frames\n", frames);
+	else if (videoBad == 0 && audioBad == 0)
+		LogInfo("[FREEINTV] Golden: %u frames match\n", frames);
+	else
+		LogError("[FREEINTV] Golden: %u frames checked, %d differ in video (first %u), %d in audio (first %u)\n",
+			frames, videoBad, firstVideo, audioBad, firstAudio);
+	GoldenMode = GOLDEN_OFF;
+}
+
+void GoldenInput(unsigned int ports[2])
+{
+	if (GoldenMode == GOLDEN_VERIFY)
+	{
+		ports[0] = expected.ports[0];
+		ports[1] = expected.ports[1];
+	}
+	else
+	{
+		expected.ports[0] = ports[0];
+		expected.ports[1] = ports[1];
+	}
+}
+
+void GoldenAudio(const int16_t *psg, int psgCount, const int16_t *voice, int voiceCount)
+{
+	int i;
+
+	for (i = 0; i < psgCount; i++)
+		audioHash = (audioHash ^ (uint16_t) psg[i]) * FNV_PRIME;
+	for (i = 0; i < voiceCount; i++)
+		audioHash = (audioHash ^ (uint16_t) voice[i]) * FNV_PRIME;
+}
+
+void GoldenFrame(const unsigned int *pixels, size_t count)
+{
+	uint64_t video = FNV_BASIS;
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		video = (video ^ (pixels[i] & 0xFFFFFF)) * FNV_PRIME;
+
+	if (GoldenMode == GOLDEN_RECORD)
+	{
+		fprintf(goldenFile, "%u %02X %02X %016llX %016llX\n", frames, expected.ports[0] & 0xFF, expected.ports[1] & 0xFF,
+			(unsigned long long) video, (unsigned long long) audioHash);
+	}
+	else
+	{
+		// every differing frame is logged, so a runner can allow a few;
+		// only the first is an error
+		if (video != expected.video)
+		{
+			if (videoBad++ == 0)
+			{
+				firstVideo = frames;
+				LogError("[FREEINTV] Golden: frame %u differs in video\n", frames);
+			}
+			else
+				LogInfo("[FREEINTV] Golden: frame %u differs in video\n", frames);
+		}
+		if (audioHash != expected.audio)
+		{
+			if (audioBad++ == 0)
+			{
+				firstAudio = frames;
+				LogError("[FREEINTV] Golden: frame %u differs in audio\n", frames);
+			}
+			else
+				LogInfo("[FREEINTV] Golden: frame %u differs in audio\n", frames);
+		}
+	}
+	frames++;
+	audioHash = FNV_BASIS;
+
+	if (GoldenMode == GOLDEN_VERIFY && !readExpected())
+		GoldenStop(); // end of the recording, input goes back to the frontend
+}
@@ -0,0 +1,51 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// Golden frame regression check.  Recording writes one line per frame
+// with the hand controller bytes the game saw and 64-bit hashes of the
+// STIC frame buffer and of the PSG and Intellivoice output as emulated.
+// Audio is hashed before it's mixed and resampled to the output rate,
+// so dynamic rate control and rewind muting don't change it.  Verifying
+// replays the recorded controller bytes instead of the frontend's input
+// and compares the hashes, logging each frame whose video or audio
+// differs (the first as an error).  Any change to stic.c, psg.c or
+// ivoice.c that is meant to be invisible must verify clean against a
+// recording made before it; tools/freeintv-golden checks a set of ROMs
+// that way.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GOLDEN_OFF    0
+#define GOLDEN_RECORD 1
+#define GOLDEN_VERIFY 2
+
+extern int GoldenMode;
+
+int GoldenRecord(const char *path); // 0 if the file can't be created
+int GoldenVerify(const char *path); // 0 if the file can't be read
+
+void GoldenInput(unsigned int ports[2]); // after the controller bytes are latched, 0x1FE-0x1FF
+void GoldenAudio(const int16_t *psg, int psgCount, const int16_t *voice, int voiceCount); // each frame, before resampling
+void GoldenFrame(const unsigned int *pixels, size_t count); // end of each emulated frame
+
+void GoldenStop(void); // close the file and log the result
+
+#endif
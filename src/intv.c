@@ -17,6 +17,7 @@
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "intv.h"
 #include "memory.h"
 #include "cp1610.h"
@@ -24,16 +25,25 @@
 #include "psg.h"
 #include "controller.h"
 #include "cart.h"
+#include "jlp.h"
 #include "osd.h"
 #include "ivoice.h"
+#include "crc.h"
+#include "perf.h"
+#include "log.h"
 
 int SR1;
 int intv_halt;
+int intv_hidden;
+unsigned int intv_frames;
+uint32_t BiosCRC;
+uint32_t EcsCRC;
 
 int exec(void);
 
 void LoadGame(const char* path) // load cart rom //
 {
+	MemoryHashInvalidate();
 	if(LoadCart(path))
 	{
 		OSD_drawText(3, 3, "LOAD CART: OKAY");
@@ -48,25 +58,28 @@ void loadExec(const char* path)
 {
 	// EXEC lives at 0x1000-0x1FFF
 	int i;
-	unsigned char word[2];
+	unsigned char rom[0x2000];
 	FILE *fp;
+	MemoryHashInvalidate();
 	if((fp = fopen(path,"rb"))!=NULL)
 	{
-		for(i=0x1000; i<=0x1FFF; i++)
+		memset(rom, 0, sizeof(rom));
+		fread(rom, 1, sizeof(rom), fp);
+		fclose(fp);
+		for(i=0; i<0x1000; i++)
 		{
-			fread(word,sizeof(word),1,fp);
-			Memory[i] = (word[0]<<8) | word[1];
+			Memory[0x1000+i] = (rom[i*2]<<8) | rom[i*2+1];
 		}
+		BiosCRC = crc32Buffer(0, rom, sizeof(rom));
 
-		fclose(fp);
 		OSD_drawText(3, 1, "LOAD EXEC: OKAY");
-		printf("[INFO] [FREEINTV] Succeeded loading Executive BIOS from: %s\n", path);		
+		LogInfo("[FREEINTV] Succeeded loading Executive BIOS from: %s\n", path);		
 	}
 	else
 	{
 		OSD_drawText(3, 1, "LOAD EXEC: FAIL");
         OSD_drawTextBG(3, 6, "PUT GROM/EXEC IN SYSTEM DIRECTORY");
-		printf("[ERROR] [FREEINTV] Failed loading Executive BIOS from: %s\n", path);
+		LogError("[FREEINTV] Failed loading Executive BIOS from: %s\n", path);
 	}
 }
 
@@ -74,35 +87,89 @@ void loadGrom(const char* path)
 {
 	// GROM lives at 0x3000-0x37FF
 	int i;
-	unsigned char word[1];
+	unsigned char rom[0x800];
 	FILE *fp;
+	MemoryHashInvalidate();
 	if((fp = fopen(path,"rb"))!=NULL)
 	{
-		for(i=0x3000; i<=0x37FF; i++)
+		memset(rom, 0, sizeof(rom));
+		fread(rom, 1, sizeof(rom), fp);
+		fclose(fp);
+		for(i=0; i<0x800; i++)
 		{
-			fread(word,sizeof(word),1,fp);
-			Memory[i] = word[0];
+			Memory[0x3000+i] = rom[i];
 		}
+		BiosCRC = crc32Buffer(BiosCRC, rom, sizeof(rom));
 
-		fclose(fp);
 		OSD_drawText(3, 2, "LOAD GROM: OKAY");
-		printf("[INFO] [FREEINTV] Succeeded loading Graphics BIOS from: %s\n", path);
+		LogInfo("[FREEINTV] Succeeded loading Graphics BIOS from: %s\n", path);
 		
 	}
 	else
 	{
 		OSD_drawText(3, 2, "LOAD GROM: FAIL");
         OSD_drawTextBG(3, 6, "PUT GROM/EXEC IN SYSTEM DIRECTORY");
-		printf("[ERROR] [FREEINTV] Failed loading Graphics BIOS from: %s\n", path);
+		LogError("[FREEINTV] Failed loading Graphics BIOS from: %s\n", path);
 	}
 }
 
+void loadECS(const char* path)
+{
+	// ECS ROM is three 4K segments: $2000 and $E000 (page 1), $7000
+	static uint16_t rom[0x3000];
+	int i;
+	unsigned char word[2];
+	uint32_t crc = 0;
+	FILE *fp;
+	MemoryHashInvalidate();
+	EcsCRC = 0;
+
+	// the second PSG and 2K of 8-bit RAM work without the ROM
+	PSGEnableECS();
+	MemoryMapRange(0x4000, 0x47FF, MEM_RAM8);
+	for(i=0x4000; i<=0x47FF; i++) { Memory[i] = 0; }
+	for(i=0x00F0; i<=0x00FD; i++) { Memory[i] = 0; } // ECS PSG
+	Memory[0xFE] = 0xFF; // keyboard / controllers 3 and 4 (not emulated)
+	Memory[0xFF] = 0xFF;
+
+	if((fp = fopen(path,"rb"))!=NULL)
+	{
+		for(i=0; i<0x3000; i++)
+		{
+			if(fread(word,sizeof(word),1,fp)!=1) { break; }
+			rom[i] = (word[0]<<8) | word[1];
+			crc = crc32Buffer(crc, word, sizeof(word));
+		}
+		fclose(fp);
+	}
+	if(fp==NULL || i<0x3000)
+	{
+		OSD_drawText(3, 4, "LOAD ECS: FAIL");
+		LogError("[FREEINTV] Failed loading ECS ROM from: %s\n", path);
+		return;
+	}
+
+	MemoryAddPage(0x2, 1, &rom[0x0000]);
+	MemoryMapRange(0x2000, 0x2FFF, MEM_ROM);
+	for(i=0; i<0x1000; i++) { Memory[0x7000+i] = rom[0x1000+i]; }
+	MemoryMapRange(0x7000, 0x7FFF, MEM_ROM);
+	MemoryAddPage(0xE, 1, &rom[0x2000]);
+	MemoryMapRange(0xE000, 0xEFFF, MEM_ROM);
+	EcsCRC = crc;
+
+	OSD_drawText(3, 4, "LOAD ECS: OKAY");
+	LogInfo("[FREEINTV] Succeeded loading ECS ROM from: %s\n", path);
+}
+
 void Reset()
 {
 	SR1 = 0;
     intv_halt = 0;
+    intv_frames = 0;
 	CP1610Reset();
 	STICReset();
+	MemoryResetPages();
+	JLPReset();
     ivoice_reset();
 }
 
@@ -119,6 +186,31 @@ void Run()
     // run for one frame
 	// exec will call drawFrame for us only when needed
 	while(exec()) { }
+	intv_frames++;
+}
+
+// Sound chips run off the CPU clock.  That is once per instruction, too
+// often to read the clock around each call, so the timers sample one
+// call in PERF_SAMPLE and count it PERF_SAMPLE times.
+static void tickSound(int ticks)
+{
+#ifdef PERF_TIMERS
+	static unsigned int calls = 0;
+	uint64_t start, mid;
+
+	if (++calls % PERF_SAMPLE == 0)
+	{
+		start = PerfNow();
+		PSGTick(ticks);
+		mid = PerfNow();
+		ivoice_tk(ticks);
+		PerfAddSample(PERF_PSG, mid - start);
+		PerfAddSample(PERF_IVOICE, PerfNow() - mid);
+		return;
+	}
+#endif
+	PSGTick(ticks);
+	ivoice_tk(ticks);
 }
 
 int exec(void) // Run one instruction 
@@ -129,25 +221,12 @@ int exec(void) // Run one instruction
 
 	if(ticks==0)    // Undefined instruction (>= 0x0400) or HLT
 	{
-        // DEBUG
-#if 0
-        {
-            FILE *debug_file;
-            extern unsigned int R[];
-
-            fprintf(stdout, "%04x:[%03x] %04x %04x %04x %04x %04x %04x %04x\n", R[7] - 1, readMem(R[7] - 1), R[0], R[1], R[2], R[3], R[4], R[5], R[6]);
-            fprintf(stdout, "%04x:[%03x] %04x %04x %04x %04x %04x %04x %04x\n", R[7], readMem(R[7]), R[0], R[1], R[2], R[3], R[4], R[5], R[6]);
-        }
-#endif
         intv_halt = 1;
 		return 0;
 	}
 
-	// Tick PSG
-	PSGTick(ticks);
- 
-    // Tick Intellivoice
-    ivoice_tk(ticks);
+	// Tick PSG and Intellivoice
+	tickSound(ticks);
     
     if(SR1>0)
     {
@@ -162,10 +241,15 @@ int exec(void) // Run one instruction
             case 0: // Start of VBLANK
                 stic_reg = 1;   // STIC registers accessible
                 stic_gram = 1;  // GRAM accessible
-                phase_len += 2900;
+                phase_len += STIC_VBLANK1_CYCLES;
                 SR1 = phase_len;
                 // Render Frame //
-                STICDrawFrame(stic_vid_enable);
+                if (!intv_hidden || STICCanCollide())
+                {
+                    PERF_BEGIN(PERF_STIC);
+                    STICDrawFrame(stic_vid_enable);
+                    PERF_END(PERF_STIC);
+                }
                 // The following line was below just after
                 //   "stic_vid_enable = DisplayEnabled;"
                 // It caused D1K Homebrew to fail:
@@ -175,7 +259,7 @@ int exec(void) // Run one instruction
                 DisplayEnabled = 0;
                 return 0;
             case 1:
-                phase_len += 3796 - 2900;
+                phase_len += STIC_VBLANK2_CYCLES;
                 stic_vid_enable = DisplayEnabled;
                 if (stic_vid_enable)
                     stic_reg = 0;   // STIC registers now inaccessible
@@ -184,39 +268,35 @@ int exec(void) // Run one instruction
             case 2:
                 delayV = ((Memory[0x31])&0x7);
                 delayH = ((Memory[0x30])&0x7);
-                phase_len += 120 + 114 * delayV + delayH;
+                phase_len += STIC_TOP_CYCLES + 114 * delayV + delayH;
                 if (stic_vid_enable) {
                     stic_gram = 0;  // GRAM now inaccessible
                     phase_len -= 68;    // BUSRQ period (STIC reads RAM)
-                    PSGTick(68);
-                    ivoice_tk(68);
+                    tickSound(68);
                 }
                 break;
             default:
-                phase_len += 912;
+                phase_len += STIC_ROW_CYCLES;
                 if (stic_vid_enable) {
                     phase_len -= 108;   // BUSRQ period (STIC reads RAM)
-                    PSGTick(108);
-                    ivoice_tk(108);
+                    tickSound(108);
                 }
                 break;
             case 14:
                 delayV = ((Memory[0x31])&0x7);
                 delayH = ((Memory[0x30])&0x7);
-                phase_len += 912 - 114 * delayV - delayH;
+                phase_len += STIC_ROW_CYCLES - 114 * delayV - delayH;
                 if (stic_vid_enable) {
                     phase_len -= 108;   // BUSRQ period (STIC reads RAM)
-                    PSGTick(108);
-                    ivoice_tk(108);
+                    tickSound(108);
                 }
                 break;
             case 15:
                 delayV = ((Memory[0x31])&0x7);
-                phase_len += 57 + 17;
+                phase_len += STIC_BOTTOM_CYCLES;
                 if (stic_vid_enable && delayV == 0) {
                     phase_len -= 38;    // BUSRQ period (STIC reads RAM)
-                    PSGTick(38);
-                    ivoice_tk(38);
+                    tickSound(38);
                 }
                 break;
                 
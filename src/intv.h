@@ -18,18 +18,31 @@
 	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <stdint.h>
+
 #define AUDIO_FREQUENCY     44100
+#define NTSC_COLORBURST     3579545
+#define CPU_FREQUENCY       (NTSC_COLORBURST / 4.0)
 
 extern int SR1; // SR1 line for interrupt
 
 extern int intv_halt;
 
+extern int intv_hidden; // frame won't be shown (run-ahead), skip drawing it when safe
+
+extern unsigned int intv_frames; // frames run since reset
+
+extern uint32_t BiosCRC; // crc32 of exec.bin then grom.bin
+extern uint32_t EcsCRC; // crc32 of ecs.bin, 0 unless loadECS attached it
+
 void LoadGame(const char *path);
 
 void loadExec(const char *path);
 
 void loadGrom(const char *path);
 
+void loadECS(const char *path);
+
 void Run(void);
 
 void Init(void);
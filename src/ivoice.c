@@ -72,20 +72,36 @@
 ivoice_t intellivoice;
 int ivoiceBufferSize;
 int16_t ivoiceBuffer[AUDIO_FREQUENCY / 60 * 2];
+int16_t ivoiceScratch[SCBUF_SIZE];
 
-void ivoiceSerialize(struct ivoiceSerialized *data)
+int ivoiceSerialize(struct ivoiceSerialized *data)
 {
-    memcpy(&data->main, &intellivoice, sizeof(intellivoice));
+    ivoice_t *ivoice = &intellivoice;
+    uint32_t i;
+    int n = 0;
+
+    memcpy(&data->main, ivoice, sizeof(intellivoice));
     data->ivoiceBufferSize = ivoiceBufferSize;
-    memcpy(data->ivoiceBuffer, ivoiceBuffer, sizeof(ivoiceBuffer));
+    for (i = ivoice->sc_tail; i < ivoice->sc_head; i++)
+        data->samples[n++] = ivoice->scratch[i & SCBUF_MASK];
+    data->scratchLen = n;
+    memcpy(&data->samples[n], ivoiceBuffer, ivoice->cur_len * sizeof(int16_t));
+    n += ivoice->cur_len;
+    return (unsigned char *) &data->samples[n] - (unsigned char *) data;
 }
 
 void ivoiceUnserialize(const struct ivoiceSerialized *data)
 {
+    ivoice_t *ivoice = &intellivoice;
+    uint32_t i;
+    int n = 0;
+
     // Copies everything except the pointers
-    memcpy(&intellivoice, &data->main, (unsigned char *) &intellivoice.cur_buf - (unsigned char *) &intellivoice);
+    memcpy(ivoice, &data->main, (unsigned char *) &intellivoice.cur_buf - (unsigned char *) &intellivoice);
     ivoiceBufferSize = data->ivoiceBufferSize;
-    memcpy(ivoiceBuffer, data->ivoiceBuffer, sizeof(ivoiceBuffer));
+    for (i = ivoice->sc_tail; i < ivoice->sc_head; i++)
+        ivoice->scratch[i & SCBUF_MASK] = data->samples[n++];
+    memcpy(ivoiceBuffer, &data->samples[n], ivoice->cur_len * sizeof(int16_t));
 }
 
 /* ======================================================================== */
@@ -1614,17 +1630,18 @@ void ivoice_dtor(void)
     ivoice_t *ivoice = &intellivoice;
 
     CONDFREE(ivoice->window);
-    CONDFREE(ivoice->scratch);
 }
 
-void ivoice_frame(void)
+/* Drop the samples consumed by the frontend this frame, keeping any     */
+/* leftover so the ~735.95 samples/frame rate does not drift.             */
+void ivoice_frame(int samples)
 {
     ivoice_t *ivoice = &intellivoice;
     int c;
     
-    c = ivoice->cur_len - AUDIO_FREQUENCY / 60;
+    c = ivoice->cur_len - samples;
     if (c > 0)
-        memmove(ivoiceBuffer, ivoiceBuffer + AUDIO_FREQUENCY / 60, c * sizeof(int16_t));
+        memmove(ivoiceBuffer, ivoiceBuffer + samples, c * sizeof(int16_t));
     else
         c = 0;
     ivoice->cur_len = c;
@@ -1701,6 +1718,7 @@ int ivoice_init
     /* -------------------------------------------------------------------- */
     /*  Allocate a scratch buffer for generating 10kHz samples.             */
     /* -------------------------------------------------------------------- */
+    ivoice->scratch = ivoiceScratch;
     ivoice->sc_head = ivoice->sc_tail = 0;
 
     /* -------------------------------------------------------------------- */
@@ -31,7 +31,6 @@ typedef struct ivoice_t
 
     int         silent;     /* Flag:  Intellivoice is silent.               */
 
-    int16_t     scratch[SCBUF_SIZE];    /* Scratch buffer for audio.        */
     uint32_t    sc_head;    /* Head/Tail pointer into scratch circular buf  */
     uint32_t    sc_tail;    /* Head/Tail pointer into scratch circular buf  */
     uint64_t    sound_current;
@@ -62,16 +61,21 @@ typedef struct ivoice_t
 
     int         cur_len;    /* Fullness of current sound buffer.            */
     int16_t    *cur_buf;    /* Current sound buffer.                        */
+    int16_t    *scratch;    /* Scratch buffer for audio.                    */
     const uint8_t *rom[16]; /* 4K ROM pages.                                */
 } ivoice_t;
 
+/* Only the live part of the audio buffers is saved: the scratch     */
+/* samples between sc_tail and sc_head, then the cur_len samples not  */
+/* yet sent to the frontend.  ivoiceSerialize returns the used size.  */
 struct ivoiceSerialized {
     ivoice_t main;
     int ivoiceBufferSize;
-    int16_t ivoiceBuffer[AUDIO_FREQUENCY / 60 * 2];
+    int scratchLen;
+    int16_t samples[SCBUF_SIZE + AUDIO_FREQUENCY / 60 * 2];
 };
 
-void ivoiceSerialize(struct ivoiceSerialized *);
+int ivoiceSerialize(struct ivoiceSerialized *);
 void ivoiceUnserialize(const struct ivoiceSerialized *);
 
 uint32_t ivoice_tk(uint32_t);
@@ -79,7 +83,7 @@ uint32_t ivoice_rd(uint32_t);
 void ivoice_wr(uint32_t, uint32_t);
 void ivoice_reset(void);
 void ivoice_dtor(void);
-void ivoice_frame(void);
+void ivoice_frame(int);
 
 /* ======================================================================== */
 /*  IVOICE_INIT  -- Makes a new Intellivoice                                */
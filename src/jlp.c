@@ -0,0 +1,267 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jlp.h"
+#include "memory.h"
+#include "log.h"
+
+#define ACCEL_ENABLE  0x4A5A // written to $8033
+#define ACCEL_DISABLE 0x6A7A // written to $8034
+#define FLASH_WRITE   0xC0DE // written to $802D: JLP RAM -> row
+#define FLASH_READ    0xDEC0 // written to $802E: row -> JLP RAM
+#define FLASH_ERASE   0xBEEF // written to $802F: erase sector of row
+
+#define JLP_RAM_FIRST 0x8040
+#define JLP_RAM_LAST  0x9F7F
+
+#define ACCEL_ARGS    0x9F80 // 6 operand pairs
+#define ACCEL_RESULT  0x9F8E // low word or quotient, then high word or remainder
+#define CRC_DATA      0x9FFC
+#define CRC_VALUE     0x9FFD
+#define RANDOM        0x9FFE
+
+#define CRC_POLY      0xAD52 // reflected, as jzIntv
+#define RANDOM_SEED   0x4A4C5021 // fixed, so runs replay exactly
+
+static int jlpMode = 0;
+static int accel;
+static int args[12];
+static int result[2];
+static int crc;
+static uint32_t randomState;
+static int ramAdr, row;
+
+static uint16_t *flash = NULL;
+static int flashRows = 0;
+
+void JLPInit(int mode, int sectors)
+{
+    int i;
+    free(flash);
+    flash = NULL;
+    flashRows = 0;
+    jlpMode = mode;
+    if (sectors > 0 && (flash = malloc(sectors * JLP_SECTOR_ROWS * JLP_ROW_WORDS * sizeof(uint16_t))) != NULL) {
+        flashRows = sectors * JLP_SECTOR_ROWS;
+        for (i = 0; i < flashRows * JLP_ROW_WORDS; i++)
+            flash[i] = 0xFFFF; // erased
+    }
+    if (jlpMode || flashRows) {
+        MemoryMapRange(0x8000, 0x80FF, MEM_JLP);
+        MemoryMapRange(0x9F00, 0x9FFF, MEM_JLP);
+        LogInfo("[FREEINTV] JLP enabled: mode %i, %i flash rows\n", jlpMode, flashRows);
+    }
+    JLPReset();
+}
+
+void JLPReset(void)
+{
+    accel = (jlpMode != 0 && jlpMode != 2);
+    memset(args, 0, sizeof(args));
+    result[0] = result[1] = 0;
+    crc = 0;
+    randomState = RANDOM_SEED;
+    ramAdr = row = 0;
+}
+
+int JLPActive(void)
+{
+    return jlpMode || flashRows;
+}
+
+uint16_t *JLPFlash(void)
+{
+    return flash;
+}
+
+size_t JLPFlashWords(void)
+{
+    return flashRows * JLP_ROW_WORDS;
+}
+
+// run the operation whose second operand was just written
+static void mulDiv(int pair)
+{
+    int a = args[pair * 2], b = args[pair * 2 + 1];
+    int32_t s1 = (int16_t) a, s2 = (int16_t) b;
+    uint32_t u1 = a, u2 = b;
+    uint32_t r;
+
+    switch (pair) {
+        case 0: r = (uint32_t) (s1 * s2); break; // signed * signed
+        case 1: r = (uint32_t) (s1 * (int32_t) u2); break; // signed * unsigned
+        case 2: r = (uint32_t) ((int32_t) u1 * s2); break; // unsigned * signed
+        case 3: r = u1 * u2; break; // unsigned * unsigned
+        case 4: // signed divide, quotient and remainder
+            result[0] = s2 ? (s1 / s2) & 0xFFFF : 0xFFFF;
+            result[1] = s2 ? (s1 % s2) & 0xFFFF : a;
+            return;
+        default: // unsigned divide
+            result[0] = u2 ? (u1 / u2) & 0xFFFF : 0xFFFF;
+            result[1] = u2 ? (u1 % u2) & 0xFFFF : a;
+            return;
+    }
+    result[0] = r & 0xFFFF;
+    result[1] = r >> 16;
+}
+
+static int crc16(int value, int data)
+{
+    int i;
+
+    value ^= data;
+    for (i = 0; i < 16; i++)
+        value = (value >> 1) ^ ((value & 1) ? CRC_POLY : 0);
+    return value;
+}
+
+static int nextRandom(void)
+{
+    // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState & 0xFFFF;
+}
+
+static int accelRead(int adr)
+{
+    if (adr >= ACCEL_ARGS && adr < ACCEL_ARGS + 12)
+        return args[adr - ACCEL_ARGS];
+    if (adr == ACCEL_RESULT || adr == ACCEL_RESULT + 1)
+        return result[adr - ACCEL_RESULT];
+    if (adr == CRC_VALUE)
+        return crc;
+    if (adr == RANDOM)
+        return nextRandom();
+    return -1;
+}
+
+static int accelWrite(int adr, int val)
+{
+    if (adr >= ACCEL_ARGS && adr < ACCEL_ARGS + 12) {
+        args[adr - ACCEL_ARGS] = val;
+        if (adr & 1)
+            mulDiv((adr - ACCEL_ARGS) >> 1);
+        return 1;
+    }
+    if (adr == ACCEL_RESULT || adr == ACCEL_RESULT + 1)
+        return 1; // read only
+    if (adr == CRC_DATA) {
+        crc = crc16(crc, val);
+        return 1;
+    }
+    if (adr == CRC_VALUE) {
+        crc = val;
+        return 1;
+    }
+    return adr == RANDOM;
+}
+
+static int validRam(void)
+{
+    return ramAdr >= JLP_RAM_FIRST && ramAdr + JLP_ROW_WORDS - 1 <= JLP_RAM_LAST;
+}
+
+static void flashCommand(int adr, int val)
+{
+    int i, first;
+    uint16_t *p;
+
+    if (row < 0 || row >= flashRows)
+        return;
+    p = &flash[row * JLP_ROW_WORDS];
+    if (adr == 0x802D && val == FLASH_WRITE && validRam()) {
+        // programming can only clear bits
+        for (i = 0; i < JLP_ROW_WORDS; i++)
+            p[i] &= readMem(ramAdr + i);
+    }
+    if (adr == 0x802E && val == FLASH_READ && validRam()) {
+        for (i = 0; i < JLP_ROW_WORDS; i++)
+            writeMem(ramAdr + i, p[i]);
+    }
+    if (adr == 0x802F && val == FLASH_ERASE) {
+        first = row - row % JLP_SECTOR_ROWS;
+        for (i = 0; i < JLP_SECTOR_ROWS * JLP_ROW_WORDS; i++)
+            flash[first * JLP_ROW_WORDS + i] = 0xFFFF;
+    }
+}
+
+int JLPRead(int adr, int *val)
+{
+    if (accel && (*val = accelRead(adr)) >= 0)
+        return 1;
+    if (flashRows) {
+        switch (adr) {
+            case 0x8023: *val = 0; return 1; // first row
+            case 0x8024: *val = flashRows - 1; return 1; // last row
+            case 0x8025: *val = ramAdr; return 1;
+            case 0x8026: *val = row; return 1;
+        }
+    }
+    return 0;
+}
+
+int JLPWrite(int adr, int val)
+{
+    if (jlpMode && adr == 0x8033 && val == ACCEL_ENABLE) {
+        accel = 1;
+        return 1;
+    }
+    if (jlpMode && adr == 0x8034 && val == ACCEL_DISABLE) {
+        accel = 0;
+        return 1;
+    }
+    if (accel && accelWrite(adr, val))
+        return 1;
+    if (flashRows) {
+        switch (adr) {
+            case 0x8025: ramAdr = val; return 1;
+            case 0x8026: row = val; return 1;
+            case 0x802D: case 0x802E: case 0x802F: flashCommand(adr, val); return 1;
+        }
+    }
+    return 0;
+}
+
+void JLPSerialize(struct JLPserialized *all)
+{
+    all->accel = accel;
+    memcpy(all->args, args, sizeof(args));
+    all->result[0] = result[0];
+    all->result[1] = result[1];
+    all->crc = crc;
+    all->randomState = randomState;
+    all->ramAdr = ramAdr;
+    all->row = row;
+}
+
+void JLPUnserialize(const struct JLPserialized *all)
+{
+    accel = all->accel;
+    memcpy(args, all->args, sizeof(args));
+    result[0] = all->result[0];
+    result[1] = all->result[1];
+    crc = all->crc;
+    randomState = all->randomState;
+    ramAdr = all->ramAdr;
+    row = all->row;
+}
@@ -0,0 +1,68 @@
+#ifndef JLP_H
+#define JLP_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+// JLP cartridge board used by modern homebrew: a multiply/divide
+// accelerator at $9F80-$9F8F, CRC-16 and random number registers at
+// $9FFC-$9FFE and flash save rows commanded through $8023-$802F.  Its
+// extra RAM ($8040-$9F7F) is ordinary memory.  Enabled per cart from the
+// .cfg [vars] "jlp" and "jlpflash".
+//
+// Each accelerator operation has its own operand pair, and writing the
+// second word of the pair runs it:
+//   $9F80/81 signed * signed      $9F86/87 unsigned * unsigned
+//   $9F82/83 signed * unsigned    $9F88/89 signed / signed
+//   $9F84/85 unsigned * signed    $9F8A/8B unsigned / unsigned
+// $9F8E then reads the low word of the product or the quotient, and
+// $9F8F the high word or the remainder.  Writing $9FFC folds a word into
+// the CRC at $9FFD, and each read of $9FFE returns a new random word.
+
+#define JLP_ROW_WORDS   96 // words per flash row
+#define JLP_SECTOR_ROWS 8  // rows erased together
+
+struct JLPserialized {
+    int accel;            // accelerator registers enabled
+    int args[12];         // operand pairs, $9F80-$9F8B
+    int result[2];        // $9F8E-$9F8F
+    int crc;              // $9FFD
+    uint32_t randomState; // $9FFE generator
+    int ramAdr;           // flash command registers
+    int row;
+};
+
+void JLPSerialize(struct JLPserialized *);
+void JLPUnserialize(const struct JLPserialized *);
+
+// mode 0 = off, 2 = accelerator off until the game enables it, other
+// values = on at reset; sectors = flash size
+void JLPInit(int mode, int sectors);
+void JLPReset(void);
+int JLPActive(void);
+
+// bus hooks for pages mapped MEM_JLP, return 1 if adr was a JLP register
+int JLPRead(int adr, int *val);
+int JLPWrite(int adr, int val);
+
+// flash contents, exposed to the frontend as save RAM
+uint16_t *JLPFlash(void);
+size_t JLPFlashWords(void);
+
+#endif
@@ -18,9 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
-#include <stdarg.h>
 #include <string.h>
-#include <errno.h>
 #include "libretro.h"
 #include "libretro_core_options.h"
 #include <file/file_path.h>
@@ -34,11 +32,20 @@
 #include "ivoice.h"
 #include "controller.h"
 #include "osd.h"
+#include "state.h"
+#include "rewind.h"
+#include "jlp.h"
+#include "cart.h"
+#include "assets.h"
+#include "log.h"
+#include "perf.h"
+#include "profile.h"
+#include "trace.h"
+#include "golden.h"
 
 // Include stb_image header (implementation in stb_image_impl.c)
 #include "stb_image.h"
 
-#define DefaultFPS 60
 #define MaxWidth 352
 #define MaxHeight 224
 
@@ -125,7 +132,17 @@ static utility_button_t utility_buttons[UTILITY_BUTTON_COUNT] = {
 
 // Display system variables
 static int dual_screen_enabled = 1;
+static int overlay_prefetch = 1;  // decode the next ROM's overlay into the disk cache
 static void* dual_screen_buffer = NULL;
+
+// Output pixels per two layout pixels: 2 sends the layout above as is
+// (1074x600), 1 halves it (537x300) and leaves scaling to the frontend.
+// Everything that doesn't change per frame is composed once at the
+// output size and only redrawn when workspace_dirty is set.
+static int workspace_scale = 2;
+static unsigned int* workspace_static = NULL;
+static int workspace_dirty = 1;
+#define WS(v) ((v) * workspace_scale / 2)
 static const int GAME_WIDTH = 352;
 static const int GAME_HEIGHT = 224;
 static int display_swap = 0;  // 0 = game left/keypad right, 1 = game right/keypad left
@@ -136,41 +153,33 @@ static int hotspot_pressed[OVERLAY_HOTSPOT_COUNT] = {0};  // Track which hotspot
 // Utility button input tracking
 static int utility_button_pressed[UTILITY_BUTTON_COUNT] = {0};  // Track which buttons are currently pressed
 
+// Pointer state for the current frame (RETRO_DEVICE_POINTER, port 0),
+// one entry per touch
+#define POINTER_MAX 4
+static struct {
+    int16_t x, y;          // normalized, -32767 to 32767
+    int pressed;
+    int mouse_x, mouse_y;  // workspace pixels
+} pointer[POINTER_MAX];
+static int pointer_count = 1;
+
+// Hit map: the workspace in HIT_MAP_CELL x HIT_MAP_CELL cells, each
+// holding what a touch there lands on, so a pointer resolves with one
+// lookup.  Rebuilt when the hotspots are laid out or display_swap flips.
+#define HIT_MAP_CELL 4
+#define HIT_MAP_WIDTH ((WORKSPACE_WIDTH + HIT_MAP_CELL - 1) / HIT_MAP_CELL)
+#define HIT_MAP_HEIGHT ((WORKSPACE_HEIGHT + HIT_MAP_CELL - 1) / HIT_MAP_CELL)
+#define HIT_NONE 0
+#define HIT_HOTSPOT 1                               // + hotspot index
+#define HIT_UTILITY (HIT_HOTSPOT + OVERLAY_HOTSPOT_COUNT) // + button index
+static unsigned char hit_map[HIT_MAP_HEIGHT][HIT_MAP_WIDTH];
+
 // PNG overlay system
 static char current_rom_path[512] = {0};
 static char system_dir[512] = {0};
 static unsigned int* overlay_buffer = NULL;
 static int overlay_loaded = 0;
 
-// Debug logging to file
-static FILE* debug_log_file = NULL;
-static void debug_log(const char* format, ...) {
-    if (!debug_log_file) {
-        // Try multiple paths
-        const char* paths[] = {
-            "/storage/emulated/0/Download/freeintv_debug.log",
-            "/data/local/tmp/freeintv_debug.log",
-            "/sdcard/freeintv_debug.log",
-            "/storage/3861-3938/freeintv_debug.log"
-        };
-        for (int i = 0; i < 4; i++) {
-            debug_log_file = fopen(paths[i], "a");
-            if (debug_log_file) {
-                fprintf(debug_log_file, "[LOG STARTED] Path: %s\n", paths[i]);
-                fflush(debug_log_file);
-                break;
-            }
-        }
-    }
-    if (debug_log_file) {
-        va_list args;
-        va_start(args, format);
-        vfprintf(debug_log_file, format, args);
-        fprintf(debug_log_file, "\n");
-        fflush(debug_log_file);
-        va_end(args);
-    }
-}
 static int overlay_width = 370;
 static int overlay_height = 600;
 
@@ -206,11 +215,49 @@ static const char* button_filenames[UTILITY_BUTTON_COUNT] = {
     "button_screenshot.png"
 };
 
+// Mark the cells whose centre falls inside a workspace rectangle
+static void hit_map_fill(int x, int y, int width, int height, unsigned char hit)
+{
+    int cx, cy;
+    int x0 = (x + HIT_MAP_CELL / 2) / HIT_MAP_CELL;
+    int y0 = (y + HIT_MAP_CELL / 2) / HIT_MAP_CELL;
+    int x1 = (x + width + HIT_MAP_CELL / 2) / HIT_MAP_CELL;
+    int y1 = (y + height + HIT_MAP_CELL / 2) / HIT_MAP_CELL;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > HIT_MAP_WIDTH) x1 = HIT_MAP_WIDTH;
+    if (y1 > HIT_MAP_HEIGHT) y1 = HIT_MAP_HEIGHT;
+    for (cy = y0; cy < y1; cy++)
+        for (cx = x0; cx < x1; cx++)
+            hit_map[cy][cx] = hit;
+}
+
+// Rebuild the hit map for the current hotspots and display_swap
+static void build_hit_map(void)
+{
+    int i;
+    memset(hit_map, HIT_NONE, sizeof(hit_map));
+    
+    // When display_swap is true, keypad moves to LEFT (0) and game moves to RIGHT (370).
+    // Hotspots are defined with keypad on RIGHT (x starts at 704), so translate them
+    for (i = 0; i < OVERLAY_HOTSPOT_COUNT; i++) {
+        overlay_hotspot_t* h = &overlay_hotspots[i];
+        hit_map_fill(display_swap ? h->x - GAME_SCREEN_WIDTH : h->x, h->y,
+                     h->width, h->height, HIT_HOTSPOT + i);
+    }
+    
+    // Utility buttons move with the game (same offset as rendering)
+    for (i = 0; i < UTILITY_BUTTON_COUNT; i++) {
+        utility_button_t* btn = &utility_buttons[i];
+        hit_map_fill((display_swap ? KEYPAD_WIDTH : 0) + btn->x, btn->y,
+                     btn->width, btn->height, HIT_UTILITY + i);
+    }
+}
+
 // Initialize overlay hotspots for keypad (positioned on RIGHT side)
 static void init_overlay_hotspots(void)
 {
-    printf("[INIT] Initializing overlay hotspots (horizontal layout)...\n");
-    fflush(stdout);
+    LogDebug("[INIT] Initializing overlay hotspots (horizontal layout)...\n");
     
     // Layout: 4 rows x 3 columns, positioned on RIGHT side of workspace
     int hotspot_w = OVERLAY_HOTSPOT_SIZE;
@@ -248,21 +295,21 @@ static void init_overlay_hotspots(void)
             overlay_hotspots[idx].height = hotspot_h;
             overlay_hotspots[idx].id = idx + 1;
             overlay_hotspots[idx].keypad_code = keypad_map[idx];
-            printf("[INIT] Hotspot %d: pos=(%d,%d), size=%dx%d, keypad_code=0x%02X\n",
+            LogDebug("[INIT] Hotspot %d: pos=(%d,%d), size=%dx%d, keypad_code=0x%02X\n",
                    idx, overlay_hotspots[idx].x, overlay_hotspots[idx].y,
                    overlay_hotspots[idx].width, overlay_hotspots[idx].height,
                    overlay_hotspots[idx].keypad_code);
         }
     }
-    printf("[INIT] Hotspot initialization complete!\n");
-    fflush(stdout);
+    build_hit_map();
+    LogDebug("[INIT] Hotspot initialization complete!\n");
 }
 
 // Helper function to build system overlay path (handles both Windows \\ and Android / paths)
 static void build_system_overlay_path(char* out_path, size_t out_size, const char* filename)
 {
     if (!out_path || !system_dir[0] || !filename) {
-        printf("[DEBUG] build_system_overlay_path: out_path=%p, system_dir_empty=%d, filename=%p\n", 
+        LogDebug("[OVERLAY] build_system_overlay_path: out_path=%p, system_dir_empty=%d, filename=%p\n", 
                out_path, !system_dir[0], filename);
         return;
     }
@@ -281,122 +328,12 @@ static void build_system_overlay_path(char* out_path, size_t out_size, const cha
         snprintf(out_path, out_size, "%s%cfreeIntv_image_assets%c%s", system_dir, sep, sep, filename);
     }
     
-    printf("[DEBUG] Built overlay path: %s\n", out_path);
-    printf("[DEBUG]   sep='%c' | trailing_sep=%d | filename=%s\n", sep, has_trailing_sep, filename);
-    
-    // Try to open file to verify it exists
-    FILE* test = fopen(out_path, "rb");
-    if (test) {
-        fclose(test);
-        printf("[DEBUG]   File status: EXISTS ✓\n");
-    } else {
-        printf("[DEBUG]   File status: NOT FOUND (errno=%d)\n", errno);
-    }
+    LogDebug("[OVERLAY] Built overlay path: %s\n", out_path);
 }
 
 // Forward declaration for build_overlay_path (ROM-specific overlay)
 static void build_overlay_path(const char* rom_path, char* overlay_path, size_t overlay_path_size);
 
-// Load controller base PNG
-static void load_controller_base(void)
-{
-    if (controller_base_loaded || !system_dir[0]) {
-        return;
-    }
-    
-    char base_path[512];
-    build_system_overlay_path(base_path, sizeof(base_path), "controller_base.png");
-    
-    int width, height, channels;
-    unsigned char* img_data = stbi_load(base_path, &width, &height, &channels, 4);
-    
-    if (!img_data) {
-        build_system_overlay_path(base_path, sizeof(base_path), "default.png");
-        img_data = stbi_load(base_path, &width, &height, &channels, 4);
-    }
-    
-    if (img_data) {
-        printf("[CONTROLLER] Loaded controller base: %dx%d\n", width, height);
-        controller_base_width = width;
-        controller_base_height = height;
-        
-        if (!controller_base) {
-            controller_base = (unsigned int*)malloc(width * height * sizeof(unsigned int));
-        }
-        
-        if (controller_base) {
-            for (int y = 0; y < height; y++) {
-                for (int x = 0; x < width; x++) {
-                    unsigned char* pixel = img_data + (y * width + x) * 4;
-                    unsigned int alpha = pixel[3];
-                    unsigned int r = pixel[0];
-                    unsigned int g = pixel[1];
-                    unsigned int b = pixel[2];
-                    controller_base[y * width + x] = (alpha << 24) | (r << 16) | (g << 8) | b;
-                }
-            }
-            controller_base_loaded = 1;
-            stbi_image_free(img_data);
-            printf("[CONTROLLER] Controller base loaded successfully\n");
-        }
-    }
-}
-
-// Load individual button images for utility buttons
-static void load_utility_buttons(void)
-{
-    if (!system_dir[0]) {
-        return;
-    }
-    
-    for (int i = 0; i < UTILITY_BUTTON_COUNT; i++) {
-        // DISABLED: Only load swap screen button (button 2)
-        // All other utility buttons are disabled
-        if (i != 2) {
-            // Skip loading for disabled buttons
-            continue;
-        }
-        
-        if (utility_button_images[i].loaded) {
-            continue;  // Already loaded
-        }
-        
-        char btn_path[512];
-        build_system_overlay_path(btn_path, sizeof(btn_path), button_filenames[i]);
-        
-        int width, height, channels;
-        unsigned char* img_data = stbi_load(btn_path, &width, &height, &channels, 4);
-        
-        if (img_data) {
-            printf("[UTILITY_BUTTON] Loaded button %d (%s): %dx%d\n", i, button_filenames[i], width, height);
-            utility_button_images[i].width = width;
-            utility_button_images[i].height = height;
-            
-            if (!utility_button_images[i].buffer) {
-                utility_button_images[i].buffer = (unsigned int*)malloc(width * height * sizeof(unsigned int));
-            }
-            
-            if (utility_button_images[i].buffer) {
-                for (int y = 0; y < height; y++) {
-                    for (int x = 0; x < width; x++) {
-                        unsigned char* pixel = img_data + (y * width + x) * 4;
-                        unsigned int alpha = pixel[3];
-                        unsigned int r = pixel[0];
-                        unsigned int g = pixel[1];
-                        unsigned int b = pixel[2];
-                        utility_button_images[i].buffer[y * width + x] = (alpha << 24) | (r << 16) | (g << 8) | b;
-                    }
-                }
-                utility_button_images[i].loaded = 1;
-                stbi_image_free(img_data);
-                printf("[UTILITY_BUTTON] Button %d loaded successfully\n", i);
-            }
-        } else {
-            printf("[UTILITY_BUTTON] Failed to load %s from %s\n", button_filenames[i], btn_path);
-        }
-    }
-}
-
 // Cleanup utility button images
 static void cleanup_utility_buttons(void)
 {
@@ -409,6 +346,7 @@ static void cleanup_utility_buttons(void)
         utility_button_images[i].width = 0;
         utility_button_images[i].height = 0;
     }
+    workspace_dirty = 1;
 }
 
 // Build overlay path from ROM name
@@ -443,101 +381,166 @@ static void build_overlay_path(const char* rom_path, char* overlay_path, size_t
     snprintf(overlay_path, overlay_path_size, 
              "%s%cfreeIntv_image_assets%c%.*s.png",
              system_dir, sep, sep, (int)name_len, filename);
-    printf("[DEBUG] ROM overlay path (sep=%c): %s\n", sep, overlay_path);
+    LogDebug("[OVERLAY] ROM overlay path: %s\n", overlay_path);
 }
 
-// Load overlay for ROM
-static void load_overlay_for_rom(const char* rom_path)
+// Asset batch slots: the ROM overlay, the controller base, then one per utility button
+#define ASSET_SLOT_OVERLAY 0
+#define ASSET_SLOT_BASE 1
+#define ASSET_SLOT_BUTTON 2
+
+// Queue the overlay images for a ROM on the asset loader.  The keypad
+// panel shows as a placeholder until install_overlay_assets runs.
+static void request_overlay_assets(const char* rom_path)
 {
-    if (!rom_path || !dual_screen_enabled) return;
+    static struct assetBatch batch; // too big for the stack
     
-    char overlay_path[1024];
-    build_overlay_path(rom_path, overlay_path, sizeof(overlay_path));
+    memset(&batch, 0, sizeof(batch));
+    batch.count = ASSET_SLOT_BUTTON + UTILITY_BUTTON_COUNT;
     
     overlay_loaded = 0;
-    
     if (overlay_buffer) {
         free(overlay_buffer);
         overlay_buffer = NULL;
     }
+    workspace_dirty = 1;
     
-    int width, height, channels;
-    unsigned char* img_data = stbi_load(overlay_path, &width, &height, &channels, 4);
+    if (!system_dir[0]) {
+        return;
+    }
     
-    if (!img_data) {
-        char jpg_path[1024];
-        strncpy(jpg_path, overlay_path, sizeof(jpg_path) - 1);
-        char* ext = strrchr(jpg_path, '.');
+    // ROM overlay: <rom>.png, then <rom>.jpg, then default.png
+    if (rom_path && dual_screen_enabled) {
+        char (*chain)[ASSET_PATH_MAX] = batch.path[ASSET_SLOT_OVERLAY];
+        build_overlay_path(rom_path, chain[0], ASSET_PATH_MAX);
+        strcpy(chain[1], chain[0]);
+        char* ext = strrchr(chain[1], '.');
         if (ext) {
             strcpy(ext, ".jpg");
-            img_data = stbi_load(jpg_path, &width, &height, &channels, 4);
         }
+        build_system_overlay_path(chain[2], ASSET_PATH_MAX, "default.png");
+        strncpy(current_rom_path, rom_path, sizeof(current_rom_path) - 1);
     }
     
-    if (!img_data && system_dir[0] != '\0') {
-        char default_path[1024];
-        build_system_overlay_path(default_path, sizeof(default_path), "default.png");
-        img_data = stbi_load(default_path, &width, &height, &channels, 4);
+    // Controller base, once per session
+    if (!controller_base_loaded) {
+        build_system_overlay_path(batch.path[ASSET_SLOT_BASE][0], ASSET_PATH_MAX, "controller_base.png");
+        build_system_overlay_path(batch.path[ASSET_SLOT_BASE][1], ASSET_PATH_MAX, "default.png");
     }
     
-    if (img_data) {
-        printf("[OVERLAY] Loaded overlay: %dx%d\n", width, height);
-        overlay_width = width;
-        overlay_height = height;
-        overlay_buffer = (unsigned int*)malloc(width * height * sizeof(unsigned int));
-        
-        if (overlay_buffer) {
-            for (int y = 0; y < height; y++) {
-                for (int x = 0; x < width; x++) {
-                    unsigned char* pixel = img_data + (y * width + x) * 4;
-                    unsigned int alpha = pixel[3];
-                    unsigned int r = pixel[0];
-                    unsigned int g = pixel[1];
-                    unsigned int b = pixel[2];
-                    overlay_buffer[y * width + x] = (alpha << 24) | (r << 16) | (g << 8) | b;
-                }
-            }
-            init_overlay_hotspots();
-        }
-        stbi_image_free(img_data);
-    } else {
-        overlay_width = 370;
-        overlay_height = 600;
-        overlay_buffer = (unsigned int*)malloc(overlay_width * overlay_height * sizeof(unsigned int));
-        if (overlay_buffer) {
-            for (int y = 0; y < overlay_height; y++) {
-                for (int x = 0; x < overlay_width; x++) {
-                    if (y < overlay_height / 2 && x < overlay_width / 2)
-                        overlay_buffer[y * overlay_width + x] = 0xFF0000FF;
-                    else if (y < overlay_height / 2)
-                        overlay_buffer[y * overlay_width + x] = 0xFF00FF00;
-                    else if (x < overlay_width / 2)
-                        overlay_buffer[y * overlay_width + x] = 0xFFFF0000;
-                    else
-                        overlay_buffer[y * overlay_width + x] = 0xFFFFFFFF;
-                }
-            }
+    for (int i = 0; i < UTILITY_BUTTON_COUNT; i++) {
+        // DISABLED: Only load swap screen button (button 2)
+        // All other utility buttons are disabled
+        if (i != 2 || utility_button_images[i].loaded) {
+            continue;
         }
+        build_system_overlay_path(batch.path[ASSET_SLOT_BUTTON + i][0], ASSET_PATH_MAX, button_filenames[i]);
     }
     
-    overlay_loaded = 1;
-    strncpy(current_rom_path, rom_path, sizeof(current_rom_path) - 1);
+    AssetsRequest(&batch);
 }
 
+// Name the overlay for a prefetched ROM; the worker calls this with the
+// ROM after the current one in its folder, as a playlist or file browser
+// would list it
+static int fill_next_overlay(const char* next, struct assetBatch* batch)
+{
+    batch->count = ASSET_SLOT_OVERLAY + 1;
+    build_overlay_path(next, batch->path[ASSET_SLOT_OVERLAY][0], ASSET_PATH_MAX);
+    if (!batch->path[ASSET_SLOT_OVERLAY][0][0]) {
+        return 0;
+    }
+    strcpy(batch->path[ASSET_SLOT_OVERLAY][1], batch->path[ASSET_SLOT_OVERLAY][0]);
+    char* dot = strrchr(batch->path[ASSET_SLOT_OVERLAY][1], '.');
+    if (dot) {
+        strcpy(dot, ".jpg");
+    }
+    return 1;
+}
 
-// Render display with game screen LEFT and keypad RIGHT
-static void render_dual_screen(void)
+// Warm the disk cache with the overlay of the ROM most likely to be
+// loaded next; the folder scan and decode both happen on the worker
+static void prefetch_next_overlay(const char* rom_path)
 {
-    if (!dual_screen_enabled) return;
+    if (!rom_path || !system_dir[0] || !dual_screen_enabled || !overlay_prefetch) {
+        return;
+    }
+    AssetsPrefetchNext(rom_path, fill_next_overlay);
+}
+
+// Take the decoded images from a finished batch
+static void install_overlay_assets(struct assetBatch* batch)
+{
+    struct asset* a;
     
-    if (!dual_screen_buffer) {
-        dual_screen_buffer = malloc(WORKSPACE_WIDTH * WORKSPACE_HEIGHT * sizeof(unsigned int));
+    a = &batch->result[ASSET_SLOT_BASE];
+    if (a->pixels) {
+        LogInfo("[CONTROLLER] Loaded controller base: %dx%d\n", a->width, a->height);
+        free(controller_base);
+        controller_base = a->pixels;
+        controller_base_width = a->width;
+        controller_base_height = a->height;
+        controller_base_loaded = 1;
+        a->pixels = NULL;
     }
-    if (!dual_screen_buffer) return;
     
-    unsigned int* dual_buffer = (unsigned int*)dual_screen_buffer;
-    extern unsigned int frame[352 * 224];
+    for (int i = 0; i < UTILITY_BUTTON_COUNT; i++) {
+        a = &batch->result[ASSET_SLOT_BUTTON + i];
+        if (!a->pixels) {
+            continue;
+        }
+        LogInfo("[UTILITY_BUTTON] Loaded button %d (%s): %dx%d\n", i, button_filenames[i], a->width, a->height);
+        free(utility_button_images[i].buffer);
+        utility_button_images[i].buffer = a->pixels;
+        utility_button_images[i].width = a->width;
+        utility_button_images[i].height = a->height;
+        utility_button_images[i].loaded = 1;
+        a->pixels = NULL;
+    }
+    
+    if (dual_screen_enabled) {
+        a = &batch->result[ASSET_SLOT_OVERLAY];
+        free(overlay_buffer);
+        overlay_buffer = NULL;
+        if (a->pixels) {
+            LogInfo("[OVERLAY] Loaded overlay: %dx%d\n", a->width, a->height);
+            overlay_width = a->width;
+            overlay_height = a->height;
+            overlay_buffer = a->pixels;
+            a->pixels = NULL;
+        } else {
+            overlay_width = 370;
+            overlay_height = 600;
+            overlay_buffer = (unsigned int*)malloc(overlay_width * overlay_height * sizeof(unsigned int));
+            if (overlay_buffer) {
+                for (int y = 0; y < overlay_height; y++) {
+                    for (int x = 0; x < overlay_width; x++) {
+                        if (y < overlay_height / 2 && x < overlay_width / 2)
+                            overlay_buffer[y * overlay_width + x] = 0xFF0000FF;
+                        else if (y < overlay_height / 2)
+                            overlay_buffer[y * overlay_width + x] = 0xFF00FF00;
+                        else if (x < overlay_width / 2)
+                            overlay_buffer[y * overlay_width + x] = 0xFFFF0000;
+                        else
+                            overlay_buffer[y * overlay_width + x] = 0xFFFFFFFF;
+                    }
+                }
+            }
+        }
+        overlay_loaded = 1;
+    }
     
+    // hotspots are centred on the controller base
+    init_overlay_hotspots();
+    AssetsFreeBatch(batch);
+    workspace_dirty = 1;
+}
+
+// Draw everything that doesn't change from frame to frame (backgrounds,
+// keypad overlay and controller base, utility buttons and border) in
+// layout coordinates.  The game screen and highlights go on top per frame.
+static void compose_workspace(unsigned int* dual_buffer)
+{
     // Clear entire workspace with black
     for (int i = 0; i < WORKSPACE_WIDTH * WORKSPACE_HEIGHT; i++) {
         dual_buffer[i] = 0xFF000000;
@@ -566,23 +569,6 @@ static void render_dual_screen(void)
         }
     }
     
-    // === GAME SCREEN ===
-    for (int y = 0; y < GAME_SCREEN_HEIGHT; ++y) {
-        int src_y = y / 2;
-        for (int x = 0; x < GAME_SCREEN_WIDTH; ++x) {
-            int src_x = x / 2;
-            int workspace_x = game_x_offset + x;
-            
-            if (workspace_x >= WORKSPACE_WIDTH) continue;
-            
-            if (src_y < GAME_HEIGHT && src_x < GAME_WIDTH) {
-                dual_buffer[y * WORKSPACE_WIDTH + workspace_x] = frame[src_y * GAME_WIDTH + src_x];
-            } else {
-                dual_buffer[y * WORKSPACE_WIDTH + workspace_x] = 0xFF000000;
-            }
-        }
-    }
-    
     // === KEYPAD ===
     // Background for keypad area
     unsigned int bg_color = 0xFF1a1a1a;
@@ -701,48 +687,7 @@ static void render_dual_screen(void)
                 }
             }
         }
-        
-        // === UTILITY BUTTON HIGHLIGHTING WHEN PRESSED ===
-        for (int i = 0; i < UTILITY_BUTTON_COUNT; i++) {
-            // DISABLED: Only highlight swap screen button (button 2)
-            // All other utility buttons are disabled
-            if (i != 2) {
-                continue;
-            }
-            
-            if (utility_button_pressed[i]) {
-                utility_button_t* btn = &utility_buttons[i];
-                unsigned int highlight_color = 0x88FFFF00;  // Yellow semi-transparent highlight
-                
-                // Apply game_x_offset to highlight position (buttons move with game)
-                int button_x_offset = game_x_offset;
-                
-                for (int y = btn->y; y < btn->y + btn->height; ++y) {
-                    if (y >= WORKSPACE_HEIGHT) continue;
-                    for (int x = button_x_offset + btn->x; x < button_x_offset + btn->x + btn->width; ++x) {
-                        if (x < 0 || x >= WORKSPACE_WIDTH) continue;
-                        
-                        unsigned int existing = dual_buffer[y * WORKSPACE_WIDTH + x];
-                        unsigned int alpha = (highlight_color >> 24) & 0xFF;
-                        unsigned int inv_alpha = 255 - alpha;
-                        
-                        unsigned int r = ((highlight_color >> 16) & 0xFF);
-                        unsigned int g = ((highlight_color >> 8) & 0xFF);
-                        unsigned int b = (highlight_color & 0xFF);
-                        
-                        unsigned int existing_r = ((existing >> 16) & 0xFF);
-                        unsigned int existing_g = ((existing >> 8) & 0xFF);
-                        unsigned int existing_b = (existing & 0xFF);
-                        
-                        unsigned int blended_r = (r * alpha + existing_r * inv_alpha) / 255;
-                        unsigned int blended_g = (g * alpha + existing_g * inv_alpha) / 255;
-                        unsigned int blended_b = (b * alpha + existing_b * inv_alpha) / 255;
-                        
-                        dual_buffer[y * WORKSPACE_WIDTH + x] = 0xFF000000 | (blended_r << 16) | (blended_g << 8) | blended_b;
-                    }
-                }
-            }
-        }
+
     } else {
         // Fallback: Draw gold rectangles if utility buttons not loaded
         unsigned int utility_color = 0xFFFFD700;
@@ -850,41 +795,132 @@ static void render_dual_screen(void)
             }
         }
     }
+}
+
+// Scale the layout down to the output size once, box filtered
+static void rebuild_workspace(void)
+{
+    static unsigned int* layout = NULL;
+    int out_w = WS(WORKSPACE_WIDTH);
+    int out_h = WS(WORKSPACE_HEIGHT);
+    
+    if (!layout) {
+        layout = malloc(WORKSPACE_WIDTH * WORKSPACE_HEIGHT * sizeof(unsigned int));
+    }
+    if (!workspace_static) {
+        workspace_static = malloc(WORKSPACE_WIDTH * WORKSPACE_HEIGHT * sizeof(unsigned int));
+    }
+    if (!layout || !workspace_static) return;
+    
+    compose_workspace(layout);
+    if (workspace_scale == 2) {
+        memcpy(workspace_static, layout, WORKSPACE_WIDTH * WORKSPACE_HEIGHT * sizeof(unsigned int));
+    } else {
+        for (int y = 0; y < out_h; y++) {
+            unsigned int* row0 = layout + (y * 2) * WORKSPACE_WIDTH;
+            unsigned int* row1 = row0 + WORKSPACE_WIDTH;
+            for (int x = 0; x < out_w; x++) {
+                unsigned int p[4] = { row0[x * 2], row0[x * 2 + 1], row1[x * 2], row1[x * 2 + 1] };
+                unsigned int r = 0, g = 0, b = 0;
+                for (int k = 0; k < 4; k++) {
+                    r += (p[k] >> 16) & 0xFF;
+                    g += (p[k] >> 8) & 0xFF;
+                    b += p[k] & 0xFF;
+                }
+                workspace_static[y * out_w + x] = 0xFF000000 | ((r / 4) << 16) | ((g / 4) << 8) | (b / 4);
+            }
+        }
+    }
+    workspace_dirty = 0;
+}
+
+// Alpha blend a solid colour over a layout-space rectangle of the output
+static void blend_workspace_rect(unsigned int* dual_buffer, int x1, int y1, int w, int h, unsigned int color)
+{
+    int out_w = WS(WORKSPACE_WIDTH);
+    int out_h = WS(WORKSPACE_HEIGHT);
+    int x2 = WS(x1 + w);
+    int y2 = WS(y1 + h);
+    unsigned int alpha = (color >> 24) & 0xFF;
+    unsigned int inv_alpha = 255 - alpha;
+    unsigned int r = ((color >> 16) & 0xFF);
+    unsigned int g = ((color >> 8) & 0xFF);
+    unsigned int b = (color & 0xFF);
+    
+    x1 = WS(x1);
+    y1 = WS(y1);
+    for (int y = y1 < 0 ? 0 : y1; y < y2 && y < out_h; ++y) {
+        for (int x = x1 < 0 ? 0 : x1; x < x2 && x < out_w; ++x) {
+            unsigned int existing = dual_buffer[y * out_w + x];
+            
+            unsigned int existing_r = ((existing >> 16) & 0xFF);
+            unsigned int existing_g = ((existing >> 8) & 0xFF);
+            unsigned int existing_b = (existing & 0xFF);
+            
+            unsigned int blended_r = (r * alpha + existing_r * inv_alpha) / 255;
+            unsigned int blended_g = (g * alpha + existing_g * inv_alpha) / 255;
+            unsigned int blended_b = (b * alpha + existing_b * inv_alpha) / 255;
+            
+            dual_buffer[y * out_w + x] = 0xFF000000 | (blended_r << 16) | (blended_g << 8) | blended_b;
+        }
+    }
+}
+
+// Render display with game screen LEFT and keypad RIGHT
+static void render_dual_screen(void)
+{
+    if (!dual_screen_enabled) return;
+    
+    if (!dual_screen_buffer) {
+        dual_screen_buffer = malloc(WORKSPACE_WIDTH * WORKSPACE_HEIGHT * sizeof(unsigned int));
+    }
+    if (!dual_screen_buffer) return;
+    
+    if (workspace_dirty) {
+        rebuild_workspace();
+    }
+    if (!workspace_static) return;
+    
+    unsigned int* dual_buffer = (unsigned int*)dual_screen_buffer;
+    extern unsigned int frame[352 * 224];
+    int out_w = WS(WORKSPACE_WIDTH);
+    int out_h = WS(WORKSPACE_HEIGHT);
+    
+    memcpy(dual_buffer, workspace_static, out_w * out_h * sizeof(unsigned int));
+    
+    // === GAME SCREEN ===
+    int game_x_offset = WS(display_swap ? KEYPAD_WIDTH : 0);
+    if (workspace_scale == 1) {
+        for (int y = 0; y < GAME_HEIGHT; ++y) {
+            memcpy(&dual_buffer[y * out_w + game_x_offset], &frame[y * GAME_WIDTH], GAME_WIDTH * sizeof(unsigned int));
+        }
+    } else {
+        for (int y = 0; y < GAME_SCREEN_HEIGHT; ++y) {
+            unsigned int* src = &frame[(y / 2) * GAME_WIDTH];
+            unsigned int* dst = &dual_buffer[y * out_w + game_x_offset];
+            for (int x = 0; x < GAME_SCREEN_WIDTH; ++x) {
+                dst[x] = src[x / 2];
+            }
+        }
+    }
+    
+    // === UTILITY BUTTON HIGHLIGHTING WHEN PRESSED ===
+    // Only the swap screen button (button 2) is enabled, and only when its image loaded
+    if (utility_button_pressed[2] && utility_button_images[2].loaded) {
+        utility_button_t* btn = &utility_buttons[2];
+        blend_workspace_rect(dual_buffer, (display_swap ? KEYPAD_WIDTH : 0) + btn->x, btn->y,
+                             btn->width, btn->height, 0x88FFFF00);  // Yellow semi-transparent highlight
+    }
     
     // === HOTSPOT HIGHLIGHTING - Show which buttons are pressed by touch ===
-    // Highlight all pressed hotspots (from touch input detection)
     // When display_swap is true, hotspots translate from right side to left side
     int hotspot_x_adjust = display_swap ? (-GAME_SCREEN_WIDTH) : 0;
     
     for (int i = 0; i < OVERLAY_HOTSPOT_COUNT; i++) {
         if (hotspot_pressed[i]) {
             overlay_hotspot_t *h = &overlay_hotspots[i];
-            unsigned int highlight_color = 0xAA00FF00;  // Green highlight for touch-pressed
-            
-            for (int y = h->y; y < h->y + h->height; ++y) {
-                if (y >= WORKSPACE_HEIGHT) continue;
-                for (int x = h->x + hotspot_x_adjust; x < h->x + h->width + hotspot_x_adjust; ++x) {
-                    if (x < 0 || x >= WORKSPACE_WIDTH) continue;
-                    
-                    unsigned int existing = dual_buffer[y * WORKSPACE_WIDTH + x];
-                    unsigned int alpha = (highlight_color >> 24) & 0xFF;
-                    unsigned int inv_alpha = 255 - alpha;
-                    
-                    unsigned int r = ((highlight_color >> 16) & 0xFF);
-                    unsigned int g = ((highlight_color >> 8) & 0xFF);
-                    unsigned int b = (highlight_color & 0xFF);
-                    
-                    unsigned int existing_r = ((existing >> 16) & 0xFF);
-                    unsigned int existing_g = ((existing >> 8) & 0xFF);
-                    unsigned int existing_b = (existing & 0xFF);
-                    
-                    unsigned int blended_r = (r * alpha + existing_r * inv_alpha) / 255;
-                    unsigned int blended_g = (g * alpha + existing_g * inv_alpha) / 255;
-                    unsigned int blended_b = (b * alpha + existing_b * inv_alpha) / 255;
-                    
-                    dual_buffer[y * WORKSPACE_WIDTH + x] = 0xFF000000 | (blended_r << 16) | (blended_g << 8) | blended_b;
-                }
-            }
+            blend_workspace_rect(dual_buffer, h->x + hotspot_x_adjust, h->y,
+                                 h->width, h->height, 0xAA00FF00);  // Green highlight for touch-pressed
         }
     }
 }
@@ -906,60 +942,65 @@ void retro_set_input_state(retro_input_state_t fn) { InputState = fn; }
 
 // Forward declarations
 void quit(int state);
+static void LatchInput(void);
 
 // ========================================
 // HOTSPOT INPUT HANDLING
 // ========================================
 
-// Process utility button touchscreen input and trigger RetroArch commands
-static void process_utility_button_input(void)
+// Read every touch once per frame; both hotspot passes share the result
+static void read_pointer_input(void)
 {
-    static int call_count = 0;
-    call_count++;
-    if (call_count % 100 == 0) {
-        debug_log("[UTILITY_INPUT] Function called %d times", call_count);
-    }
+    int i;
     
-    // Get pointer/touchscreen input (RETRO_DEVICE_POINTER for touchscreen, RETRO_DEVICE_MOUSE for mouse)
-    int16_t ptr_x_normalized = (int16_t)InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_X);
-    int16_t ptr_y_normalized = (int16_t)InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_Y);
-    int mouse_button = InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_PRESSED);
+    pointer_count = InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_COUNT);
+    if (pointer_count < 1) pointer_count = 1; // frontend doesn't report a count
+    if (pointer_count > POINTER_MAX) pointer_count = POINTER_MAX;
     
-    // Transform from normalized coordinates (-32767 to 32767) to pixel coordinates (0 to WORKSPACE_WIDTH/HEIGHT)
-    int mouse_x = 0;
-    int mouse_y = 0;
-    if (ptr_x_normalized != 0 || ptr_y_normalized != 0 || mouse_button) {
-        mouse_x = ((int32_t)ptr_x_normalized + 32767) * WORKSPACE_WIDTH / 65534;
-        mouse_y = ((int32_t)ptr_y_normalized + 32767) * WORKSPACE_HEIGHT / 65534;
-        // Clamp to workspace bounds
-        if (mouse_x < 0) mouse_x = 0;
-        if (mouse_x >= WORKSPACE_WIDTH) mouse_x = WORKSPACE_WIDTH - 1;
-        if (mouse_y < 0) mouse_y = 0;
-        if (mouse_y >= WORKSPACE_HEIGHT) mouse_y = WORKSPACE_HEIGHT - 1;
+    for (i = 0; i < pointer_count; i++) {
+        pointer[i].x = (int16_t)InputState(0, RETRO_DEVICE_POINTER, i, RETRO_DEVICE_ID_POINTER_X);
+        pointer[i].y = (int16_t)InputState(0, RETRO_DEVICE_POINTER, i, RETRO_DEVICE_ID_POINTER_Y);
+        pointer[i].pressed = InputState(0, RETRO_DEVICE_POINTER, i, RETRO_DEVICE_ID_POINTER_PRESSED);
+        
+        // Transform from normalized coordinates (-32767 to 32767) to pixel coordinates (0 to WORKSPACE_WIDTH/HEIGHT)
+        // Formula: pixel = (normalized + 32767) / 65534 * workspace_size
+        // This maps -32767 -> 0, 0 -> 50% of screen, 32767 -> 100%
+        pointer[i].mouse_x = 0;
+        pointer[i].mouse_y = 0;
+        if (pointer[i].x != 0 || pointer[i].y != 0 || pointer[i].pressed) {
+            pointer[i].mouse_x = ((int32_t)pointer[i].x + 32767) * WORKSPACE_WIDTH / 65534;
+            pointer[i].mouse_y = ((int32_t)pointer[i].y + 32767) * WORKSPACE_HEIGHT / 65534;
+            // Clamp to workspace bounds
+            if (pointer[i].mouse_x < 0) pointer[i].mouse_x = 0;
+            if (pointer[i].mouse_x >= WORKSPACE_WIDTH) pointer[i].mouse_x = WORKSPACE_WIDTH - 1;
+            if (pointer[i].mouse_y < 0) pointer[i].mouse_y = 0;
+            if (pointer[i].mouse_y >= WORKSPACE_HEIGHT) pointer[i].mouse_y = WORKSPACE_HEIGHT - 1;
+        }
     }
+}
+
+// What a touch is over (HIT_NONE if it isn't pressed)
+static int pointer_hit(int i)
+{
+    if (!pointer[i].pressed)
+        return HIT_NONE;
+    return hit_map[pointer[i].mouse_y / HIT_MAP_CELL][pointer[i].mouse_x / HIT_MAP_CELL];
+}
+
+// Process utility button touchscreen input and trigger RetroArch commands
+static void process_utility_button_input(void)
+{
+    int held = 0; // utility buttons under a touch, one bit each
+    int i, hit;
     
-    static int last_mouse_x = -1;
-    static int last_mouse_y = -1;
-    static int coord_logged = 0;
-    
-    // Log coordinates on change or button press
-    if (mouse_button && (!coord_logged || mouse_x != last_mouse_x || mouse_y != last_mouse_y)) {
-        debug_log("[UTILITY] TOUCH DETECTED! Raw: x_norm=%d y_norm=%d -> Transformed: x=%d y=%d button=%d", 
-                  ptr_x_normalized, ptr_y_normalized, mouse_x, mouse_y, mouse_button);
-        for (int i = 0; i < UTILITY_BUTTON_COUNT; i++) {
-            utility_button_t* btn = &utility_buttons[i];
-            int is_over = (mouse_x >= btn->x && mouse_x < btn->x + btn->width &&
-                          mouse_y >= btn->y && mouse_y < btn->y + btn->height);
-            debug_log("  Btn%d [x=%d-%d y=%d-%d]: %s", i, btn->x, btn->x+btn->width, btn->y, btn->y+btn->height, is_over?"HIT":"miss");
-        }
-        last_mouse_x = mouse_x;
-        last_mouse_y = mouse_y;
-        coord_logged = 1;
+    for (i = 0; i < pointer_count; i++) {
+        hit = pointer_hit(i);
+        if (hit >= HIT_UTILITY)
+            held |= 1 << (hit - HIT_UTILITY);
     }
-    if (!mouse_button) coord_logged = 0;
     
     // Track pressed buttons
-    for (int i = 0; i < UTILITY_BUTTON_COUNT; i++)
+    for (i = 0; i < UTILITY_BUTTON_COUNT; i++)
     {
         // DISABLED: Only process swap screen button (button 2)
         // All other utility buttons are disabled
@@ -969,17 +1010,7 @@ static void process_utility_button_input(void)
             continue;
         }
         
-        utility_button_t* btn = &utility_buttons[i];
-        
-        // When display_swap is true, utility buttons move with game (apply same offset as rendering)
-        // Use the same offset calculation as the rendering: display_swap ? KEYPAD_WIDTH : 0
-        int button_x = (display_swap ? KEYPAD_WIDTH : 0) + btn->x;
-        
-        // Check if mouse is over this button
-        int is_over = (mouse_x >= button_x && mouse_x < button_x + btn->width &&
-                       mouse_y >= btn->y && mouse_y < btn->y + btn->height);
-        
-        if (is_over && mouse_button)
+        if (held & (1 << i))
         {
             // Button was pressed/held over this button
             if (!utility_button_pressed[i])
@@ -991,139 +1022,126 @@ static void process_utility_button_input(void)
                 switch(i)
                 {
                     case 2:  // Swap screen button
-                        debug_log("[BUTTON] Swap screen button pressed at x=%d y=%d", mouse_x, mouse_y);
+                        LogDebug("[BUTTON] Swap screen button pressed\n");
                         display_swap = !display_swap;
+                        build_hit_map();
+                        workspace_dirty = 1;
                         break;
                 }
             }
         }
         else
         {
-            // Button released or mouse moved away
+            // Button released or touch moved away
             if (utility_button_pressed[i])
             {
                 utility_button_pressed[i] = 0;
-                printf("[BUTTON] Button %d released\n", i);
+                LogDebug("[BUTTON] Button %d released\n", i);
             }
         }
     }
 }
 
-// Process hotspot input and update controller state directly
+// Process hotspot input and update controller state directly.  Every
+// touch is resolved, so several keypad buttons can be held at once.
 static void process_hotspot_input(void)
 {
-    static int call_count = 0;
-    call_count++;
+    int held = 0; // hotspots under a touch, one bit each
+    int i, hit;
     
-    // Get pointer/touchscreen input (RETRO_DEVICE_POINTER for touchscreen on Android)
-    // Pointer returns coordinates in -32767 to 32767 range (normalized, not pixel coords)
-    int16_t ptr_x_normalized = (int16_t)InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_X);
-    int16_t ptr_y_normalized = (int16_t)InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_Y);
-    int mouse_button = InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_PRESSED);
-    
-    // Transform from normalized coordinates (-32767 to 32767) to pixel coordinates (0 to WORKSPACE_WIDTH/HEIGHT)
-    // Formula: pixel = (normalized + 32767) / 65534 * workspace_size
-    // This maps -32767 -> 0, 0 -> 50% of screen, 32767 -> 100%
-    int mouse_x = 0;
-    int mouse_y = 0;
-    if (ptr_x_normalized != 0 || ptr_y_normalized != 0 || mouse_button) {
-        // Transform coordinates
-        mouse_x = ((int32_t)ptr_x_normalized + 32767) * WORKSPACE_WIDTH / 65534;
-        mouse_y = ((int32_t)ptr_y_normalized + 32767) * WORKSPACE_HEIGHT / 65534;
-        // Clamp to workspace bounds
-        if (mouse_x < 0) mouse_x = 0;
-        if (mouse_x >= WORKSPACE_WIDTH) mouse_x = WORKSPACE_WIDTH - 1;
-        if (mouse_y < 0) mouse_y = 0;
-        if (mouse_y >= WORKSPACE_HEIGHT) mouse_y = WORKSPACE_HEIGHT - 1;
-        
-        // Log HOTSPOT activity
-        debug_log("[HOTSPOT_INPUT] Call#%d: mouse_x=%d, mouse_y=%d, button=%d, ptr_x_norm=%d, ptr_y_norm=%d",
-                  call_count, mouse_x, mouse_y, mouse_button, ptr_x_normalized, ptr_y_normalized);
+    for (i = 0; i < pointer_count; i++) {
+        hit = pointer_hit(i);
+        if (hit >= HIT_HOTSPOT && hit < HIT_UTILITY)
+            held |= 1 << (hit - HIT_HOTSPOT);
     }
     
     // Track pressed hotspots
-    for (int i = 0; i < OVERLAY_HOTSPOT_COUNT; i++)
+    for (i = 0; i < OVERLAY_HOTSPOT_COUNT; i++)
     {
-        overlay_hotspot_t* h = &overlay_hotspots[i];
-        
-        // When display_swap is true, keypad moves to LEFT (0) and game moves to RIGHT (370)
-        // Hotspots are defined with keypad on RIGHT (x starts at 704), so translate them
-        // In normal mode: hotspot at original x position
-        // In swapped mode: subtract GAME_SCREEN_WIDTH (704) to move to LEFT side
-        int hotspot_x = h->x;
-        if (display_swap) {
-            // Translate hotspot from RIGHT side to LEFT side
-            // Original x is ~750-883 (right side), new x should be ~46-179 (left side, same relative position)
-            hotspot_x = h->x - GAME_SCREEN_WIDTH;
-        }
-        
-        // Check if mouse is over this hotspot
-        int is_over = (mouse_x >= hotspot_x && mouse_x < hotspot_x + h->width &&
-                       mouse_y >= h->y && mouse_y < h->y + h->height);
-        
-        if (is_over && mouse_button)
+        if (held & (1 << i))
         {
-            // Button was pressed/held over this hotspot
             if (!hotspot_pressed[i])
             {
                 // Button press detected - send keypad code
                 hotspot_pressed[i] = 1;
-                debug_log("[HOTSPOT_PRESS] Button %d (idx=%d) pressed at (%d,%d) code=0x%02X",
-                          i, i, mouse_x, mouse_y, h->keypad_code);
+                LogDebug("[HOTSPOT] Button %d pressed code=0x%02X\n",
+                         i, overlay_hotspots[i].keypad_code);
             }
         }
         else
         {
-            // Button released or mouse moved away
+            // Button released or touch moved away
             if (hotspot_pressed[i])
             {
                 hotspot_pressed[i] = 0;
-                debug_log("[HOTSPOT_RELEASE] Button %d released", i);
+                LogDebug("[HOTSPOT] Button %d released\n", i);
             }
         }
     }
     
     // Build controller input from pressed hotspots (including held buttons from previous frames)
     int hotspot_input = 0;
-    for (int i = 0; i < OVERLAY_HOTSPOT_COUNT; i++)
+    for (i = 0; i < OVERLAY_HOTSPOT_COUNT; i++)
     {
         // Send hotspot input if currently pressed
         if (hotspot_pressed[i])
-        {
             hotspot_input |= overlay_hotspots[i].keypad_code;
-            debug_log("[HOTSPOT_COMBINE] Button %d: code=0x%02X, combined=0x%02X",
-                      i, overlay_hotspots[i].keypad_code, hotspot_input);
-        }
     }
     
     // Send hotspot input directly to controller 0 (player 1)
     if (hotspot_input)
-    {
-        debug_log("[HOTSPOT_SEND] hotspot_input=0x%02X -> setControllerInput(0, 0x%02X)",
-                  hotspot_input, hotspot_input);
         setControllerInput(0, hotspot_input);
-    }
 }
 
 struct retro_game_geometry Geometry;
 
 static bool libretro_supports_option_categories = false;
 
-int joypad0[20]; // joypad 0 state
-int joypad1[20]; // joypad 1 state
-int joypre0[20]; // joypad 0 previous state
-int joypre1[20]; // joypad 1 previous state
+struct joypadState joypad[2]; // player 1, player 2
+static bool inputBitmasks = false; // frontend supports RETRO_DEVICE_ID_JOYPAD_MASK
 
 bool paused = false;
+static int showKeypad0 = false;
+static int showKeypad1 = false;
 
 bool keyboardChange = false;
 bool keyboardDown = false;
 int  keyboardState = 0;
 
-// at 44.1khz, read 735 samples (44100/60) 
-// at 48khz, read 800 samples (48000/60)
-// e.g. audioInc = 3733.5 / 735
-int audioSamples = AUDIO_FREQUENCY / 60;
+// A frame is STIC_FRAME_CYCLES (14934) CPU cycles, about 59.92 fps, so
+// at 44.1khz a frame is ~735.95 samples.  The count for each frame comes
+// from the emulated frame number, so the output rate matches the emulated
+// clock and is the same after loading a state.
+#define FRAME_RATE (CPU_FREQUENCY / STIC_FRAME_CYCLES)
+double audioOutputFrac = 0.0; // rate-controlled samples carried to next frame
+
+// Dynamic rate control: nudge the output sample count by up to
+// AUDIO_RATE_CONTROL_DELTA to keep the frontend audio buffer half full.
+// The pitch change (0.5%) is inaudible but lets a small audio buffer
+// absorb the drift between emulated and host refresh without underruns.
+#define AUDIO_RATE_CONTROL_DELTA 0.005
+bool audioRateControl = false;
+bool audioBufferActive = false;
+unsigned audioBufferOccupancy = 50;
+unsigned audioLatency = 0;
+bool audioLatencyChange = false;
+
+bool rewindKey = false; // Backspace held
+unsigned rewindBuffer = 0; // in-core rewind budget in MB, 0 = off
+
+int runAhead = 0; // frames to run ahead, 0 = off
+bool stateHashLog = false;
+#ifdef PERF_TIMERS
+static bool perfHud = false;
+static bool perfLog = false;
+#endif
+static unsigned char *runAheadState = NULL;
+static size_t runAheadSize = 0;
+
+bool bootCache = false;
+static bool bootCapture = false; // waiting for the EXEC to read the controllers
+static char bootCachePath[PATH_MAX_LENGTH];
+#define BOOT_CAPTURE_FRAMES 1200 // give up if the controllers aren't read by then
 
 double audioBufferPos = 0.0;
 double audioInc;
@@ -1140,12 +1158,18 @@ void quit(int state)
 	cleanup_utility_buttons();
 	Reset();
 	MemoryInit();
+	PSGInit();
 }
 
 static void Keyboard(bool down, unsigned keycode,
       uint32_t character, uint16_t key_modifiers)
 {
 	/* Keyboard Input */
+	if (keycode == RETROK_BACKSPACE)
+	{
+		rewindKey = down;
+		return;
+	}
 	keyboardDown = down;
 	keyboardChange = true; 
 	switch (character)
@@ -1168,9 +1192,194 @@ static void Keyboard(bool down, unsigned keycode,
 	}
 }
 
+// samples due in frame n, the difference of floor(n * 735.95...)
+static int frameSamples(unsigned int n)
+{
+	uint64_t num = (uint64_t) AUDIO_FREQUENCY * STIC_FRAME_CYCLES * 4;
+
+	return (int) ((uint64_t) n * num / NTSC_COLORBURST - (uint64_t) (n - 1) * num / NTSC_COLORBURST);
+}
+
+// Native run-ahead: run `frames` hidden frames with the current input so
+// the picture shown reflects it sooner, then return to the real timeline.
+// Memory is restored through copy-on-write page tracking and the rest of
+// the machine from a savestate without the MEM chunk, which is far
+// cheaper than the frontend's full serialize/unserialize pair.
+// The hidden frames are silent and only the last one is displayed, so
+// the STIC only draws the others when a MOB collision could result.
+static void RunAhead(int frames)
+{
+	int profiling = ProfileEnabled;
+	int tracing = TraceEnabled;
+	int i;
+
+	if (runAheadState == NULL)
+	{
+		runAheadSize = StateMaxSize();
+		runAheadState = (unsigned char *) malloc(runAheadSize);
+		if (runAheadState == NULL)
+			return;
+	}
+	if (!StateSave(runAheadState, runAheadSize, STATE_NO_MEMORY))
+		return;
+
+	MemoryCheckpoint();
+	ProfileEnabled = 0; // thrown away, don't count it
+	TraceEnabled = 0;
+	for (i = 0; i < frames; i++)
+	{
+		intv_hidden = (i < frames - 1);
+		Run();
+		PSGFrame();
+		ivoice_frame(frameSamples(intv_frames));
+	}
+	intv_hidden = 0;
+	ProfileEnabled = profiling;
+	TraceEnabled = tracing;
+	MemoryRestore();
+	StateLoad(runAheadState, runAheadSize, STATE_NO_MEMORY);
+}
+
+// CPU profiler and trace reports go to the save folder, or next to the ROM
+static char reportRom[PATH_MAX_LENGTH];
+static int traceMode = 0; // cpu_trace: 0 disabled, 1 enabled, 2 verify
+static int goldenMode = GOLDEN_OFF;
+
+static const char *ReportDir(char *romDir)
+{
+	const char *dir = NULL;
+
+	if (!Environ(RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY, &dir) || dir == NULL || dir[0] == '\0')
+	{
+		fill_pathname_basedir(romDir, reportRom, PATH_MAX_LENGTH);
+		dir = romDir;
+	}
+	return dir;
+}
+
+static void StopProfiler(void)
+{
+	char romDir[PATH_MAX_LENGTH];
+
+	if (ProfileEnabled)
+		ProfileStop(reportRom, ReportDir(romDir));
+}
+
+// write out the trace ring and stop recording; TraceStop frees it
+static void DumpTrace(void)
+{
+	char romDir[PATH_MAX_LENGTH];
+
+	if (!TraceEnabled && !TraceDiverged)
+		return;
+	TraceEnabled = TraceDiverged = 0;
+	TraceDump(reportRom, ReportDir(romDir));
+}
+
+// <game><suffix> in the save folder
+static void ReportPath(char *path, const char *suffix)
+{
+	char romDir[PATH_MAX_LENGTH], base[PATH_MAX_LENGTH], name[PATH_MAX_LENGTH + 16];
+
+	fill_pathname_base_noext(base, reportRom, PATH_MAX_LENGTH);
+	snprintf(name, sizeof(name), "%s%s", base, suffix);
+	fill_pathname_join(path, ReportDir(romDir), name, PATH_MAX_LENGTH);
+}
+
+// open a reference file, <game><suffix> in the save folder then beside the ROM
+static int OpenReference(const char *suffix, int (*open)(const char *path))
+{
+	char romDir[PATH_MAX_LENGTH], base[PATH_MAX_LENGTH], name[PATH_MAX_LENGTH + 16], path[PATH_MAX_LENGTH];
+
+	ReportPath(path, suffix);
+	if (open(path))
+		return 1;
+	fill_pathname_base_noext(base, reportRom, PATH_MAX_LENGTH);
+	snprintf(name, sizeof(name), "%s%s", base, suffix);
+	fill_pathname_basedir(romDir, reportRom, PATH_MAX_LENGTH);
+	fill_pathname_join(path, romDir, name, PATH_MAX_LENGTH);
+	if (open(path))
+		return 1;
+	LogError("[FREEINTV] No %s to verify against\n", name);
+	return 0;
+}
+
+// Boot snapshot cache: the first launch of a cart runs the EXEC boot
+// as usual and saves the machine at the end of the first frame that
+// reads the hand controller ports; later launches restore that file
+// instead of booting.  Snapshots are keyed by the cart and BIOS CRC32s,
+// plus the ECS ROM's for carts that attach it.
+static void BootCacheLoad(void)
+{
+	const char *dir = NULL;
+	char name[64];
+	unsigned char *buf;
+	size_t size = StateMaxSize();
+	size_t len;
+	FILE *fp;
+
+	bootCapture = false;
+	if (!Environ(RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY, &dir) || dir == NULL || dir[0] == '\0')
+		return;
+	if (CartECS)
+		snprintf(name, sizeof(name), "FreeIntv-boot-%08X-%08X-%08X.state",
+			(unsigned int) CartCRC(), (unsigned int) BiosCRC, (unsigned int) EcsCRC);
+	else
+		snprintf(name, sizeof(name), "FreeIntv-boot-%08X-%08X.state",
+			(unsigned int) CartCRC(), (unsigned int) BiosCRC);
+	fill_pathname_join(bootCachePath, dir, name, PATH_MAX_LENGTH);
+
+	if ((fp = fopen(bootCachePath, "rb")) != NULL)
+	{
+		buf = (unsigned char *) malloc(size);
+		len = buf ? fread(buf, 1, size, fp) : 0;
+		fclose(fp);
+		if (len > 0 && StateLoad(buf, len, STATE_ALL))
+		{
+			LogInfo("[FREEINTV] Restored boot snapshot: %s\n", bootCachePath);
+			free(buf);
+			return;
+		}
+		free(buf);
+		LogError("[FREEINTV] Ignoring bad boot snapshot: %s\n", bootCachePath);
+	}
+	bootCapture = true;
+}
+
+static void BootCacheSave(void)
+{
+	unsigned char *buf;
+	size_t size = StateMaxSize();
+	size_t len;
+	FILE *fp;
+
+	bootCapture = false;
+	if ((buf = (unsigned char *) malloc(size)) == NULL)
+		return;
+	len = StateSave(buf, size, STATE_ALL);
+	if (len > 0 && (fp = fopen(bootCachePath, "wb")) != NULL)
+	{
+		if (fwrite(buf, 1, len, fp) == len)
+			LogInfo("[FREEINTV] Saved boot snapshot at frame %u: %s\n", intv_frames, bootCachePath);
+		fclose(fp);
+	}
+	free(buf);
+}
+
+static void RETRO_CALLCONV AudioBufferStatus(bool active, unsigned occupancy, bool underrun_likely)
+{
+	audioBufferActive = active;
+	audioBufferOccupancy = underrun_likely ? 0 : occupancy;
+}
+
 static void check_variables(bool first_run)
 {
 	struct retro_variable var = {0};
+	struct retro_audio_buffer_status_callback buf_status_cb = { AudioBufferStatus };
+	bool rate_control = false;
+	unsigned latency = 0;
+	unsigned rewind = 0;
+	int scale;
 
 	if (first_run)
 	{
@@ -1187,6 +1396,165 @@ static void check_variables(bool first_run)
 				controllerSwap = 1;
 		}
 	}
+
+	var.key   = "audio_rate_control";
+	var.value = NULL;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		rate_control = (strcmp(var.value, "enabled") == 0);
+
+	if (rate_control != audioRateControl || first_run)
+	{
+		// frontend may not support buffer status; run without it
+		if (!Environ(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK,
+				rate_control ? &buf_status_cb : NULL))
+			rate_control = false;
+		audioRateControl = rate_control;
+		audioBufferActive = false;
+		audioBufferOccupancy = 50;
+	}
+
+	var.key   = "audio_latency";
+	var.value = NULL;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		latency = atoi(var.value);
+
+	// SET_MINIMUM_AUDIO_LATENCY may only be called from retro_run
+	if (latency != audioLatency)
+	{
+		audioLatency = latency;
+		audioLatencyChange = true;
+	}
+
+	var.key   = "run_ahead";
+	var.value = NULL;
+	runAhead = 0;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		runAhead = atoi(var.value); // "disabled" reads as 0
+
+	var.key   = "state_hash_log";
+	var.value = NULL;
+	stateHashLog = false;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		stateHashLog = (strcmp(var.value, "enabled") == 0);
+
+#ifdef PERF_TIMERS
+	var.key   = "perf_timers";
+	var.value = NULL;
+	perfHud = perfLog = false;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+	{
+		perfHud = (strcmp(var.value, "hud") == 0);
+		perfLog = (strcmp(var.value, "log") == 0);
+	}
+#endif
+
+	var.key   = "cpu_profiler";
+	var.value = NULL;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && strcmp(var.value, "enabled") == 0)
+	{
+		if (!ProfileEnabled)
+			ProfileStart();
+	}
+	else if (ProfileEnabled)
+		StopProfiler();
+
+	var.key   = "cpu_trace";
+	var.value = NULL;
+	{
+		int mode = 0;
+
+		if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		{
+			if (strcmp(var.value, "enabled") == 0)
+				mode = 1;
+			else if (strcmp(var.value, "verify") == 0)
+				mode = 2;
+		}
+		if (mode != traceMode)
+		{
+			if (traceMode)
+			{
+				DumpTrace();
+				TraceStop();
+			}
+			traceMode = mode;
+			if (mode == 1 && !TraceStart())
+				traceMode = 0;
+			if (mode == 2 && !OpenReference(".ref.txt", TraceVerifyStart))
+				traceMode = 0;
+		}
+	}
+
+	var.key   = "golden";
+	var.value = NULL;
+	{
+		int mode = GOLDEN_OFF;
+		char path[PATH_MAX_LENGTH];
+
+		if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		{
+			if (strcmp(var.value, "record") == 0)
+				mode = GOLDEN_RECORD;
+			else if (strcmp(var.value, "verify") == 0)
+				mode = GOLDEN_VERIFY;
+		}
+		// a recording or check runs from the start of the game, so only on load
+		if (first_run && mode != goldenMode)
+		{
+			goldenMode = mode;
+			if (mode == GOLDEN_RECORD)
+			{
+				ReportPath(path, ".golden.txt");
+				GoldenRecord(path);
+			}
+			if (mode == GOLDEN_VERIFY)
+				OpenReference(".golden.txt", GoldenVerify);
+		}
+	}
+
+	var.key   = "boot_cache";
+	var.value = NULL;
+	bootCache = false;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		bootCache = (strcmp(var.value, "enabled") == 0);
+	if (goldenMode != GOLDEN_OFF)
+		bootCache = false; // golden frames start from the EXEC boot
+
+	var.key   = "workspace_scale";
+	var.value = NULL;
+	scale = 2;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		scale = atoi(var.value) == 1 ? 1 : 2;
+
+	if (scale != workspace_scale)
+	{
+		workspace_scale = scale;
+		workspace_dirty = 1;
+		if (!first_run && dual_screen_enabled)
+		{
+			struct retro_game_geometry geometry = {
+				WS(WORKSPACE_WIDTH), WS(WORKSPACE_HEIGHT), WORKSPACE_WIDTH, WORKSPACE_HEIGHT,
+				((float)WORKSPACE_WIDTH) / ((float)WORKSPACE_HEIGHT)
+			};
+			Environ(RETRO_ENVIRONMENT_SET_GEOMETRY, &geometry);
+		}
+	}
+
+	var.key   = "overlay_prefetch";
+	var.value = NULL;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		overlay_prefetch = (strcmp(var.value, "enabled") == 0);
+
+	var.key   = "rewind_buffer";
+	var.value = NULL;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+		rewind = atoi(var.value); // "disabled" reads as 0
+
+	if (rewind != rewindBuffer)
+	{
+		rewindBuffer = rewind;
+		RewindInit((size_t) rewind << 20);
+	}
 }
 
 void retro_set_environment(retro_environment_t fn)
@@ -1203,6 +1571,7 @@ void retro_init(void)
 	char execPath[PATH_MAX_LENGTH];
 	char gromPath[PATH_MAX_LENGTH];
 	struct retro_keyboard_callback kb = { Keyboard };
+	struct retro_log_callback logging;
 
 	// controller descriptors
 	struct retro_input_descriptor desc[] = {
@@ -1247,15 +1616,19 @@ void retro_init(void)
 		{ 0 },
 	};
 
+	LogInit(Environ(RETRO_ENVIRONMENT_GET_LOG_INTERFACE, &logging) ? logging.log : NULL);
+
 	// init buffers, structs
 	memset(frame, 0, frameSize);
 	OSD_setDisplay(frame, MaxWidth, MaxHeight);
 
 	Environ(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
+	inputBitmasks = Environ(RETRO_ENVIRONMENT_GET_INPUT_BITMASKS, NULL);
 
 	// reset console
 	Init();
 	Reset();
+	MemoryPortHook = LatchInput;
 
 	// get paths
 	Environ(RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY, &SystemPath);
@@ -1270,129 +1643,187 @@ void retro_init(void)
 
 	// Setup keyboard input
 	Environ(RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK, &kb);
+	LogFlush();
 }
 
 bool retro_load_game(const struct retro_game_info *info)
 {
+	char ecsPath[PATH_MAX_LENGTH];
+
+	strncpy(reportRom, info->path, PATH_MAX_LENGTH - 1);
 	check_variables(true);
 	LoadGame(info->path);
+	if (CartECS)
+	{
+		// attach the ECS for carts that need it
+		fill_pathname_join(ecsPath, SystemPath, "ecs.bin", PATH_MAX_LENGTH);
+		loadECS(ecsPath);
+	}
+	if (bootCache)
+		BootCacheLoad();
 	
 	// Capture system directory and load overlays
 	if (SystemPath && SystemPath[0]) {
 		strncpy(system_dir, SystemPath, sizeof(system_dir) - 1);
 		system_dir[sizeof(system_dir) - 1] = '\0';
-		printf("[GAME] ==================== SYSTEM DIR DEBUG ====================\n");
-		printf("[GAME] Raw SystemPath from RetroArch: %s\n", SystemPath);
-		printf("[GAME] Copied to system_dir: %s\n", system_dir);
-		printf("[GAME] system_dir length: %zu\n", strlen(system_dir));
-		printf("[GAME] Last char: '%c' (code %d)\n", system_dir[strlen(system_dir)-1], system_dir[strlen(system_dir)-1]);
-		printf("[GAME] ============================================================\n");
+		LogDebug("[GAME] System directory: %s\n", system_dir);
 		
-		// Load controller base, utility buttons, and ROM-specific overlay
-		load_controller_base();
-		load_utility_buttons();
-		load_overlay_for_rom(info->path);
+		// Decode controller base, utility buttons, and ROM-specific overlay in the
+		// background; the keypad panel is a placeholder until they arrive
+		{
+			const char *saveDir = NULL;
+			if (Environ(RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY, &saveDir))
+				AssetsSetCacheDir(saveDir);
+		}
+		request_overlay_assets(info->path);
+		prefetch_next_overlay(info->path);
 		init_overlay_hotspots();
 	} else {
-		printf("[GAME] ERROR: SystemPath is NULL or empty!\n");
+		LogError("[GAME] SystemPath is NULL or empty!\n");
 	}
 	
+	LogFlush();
 	return true;
 }
 
 void retro_unload_game(void)
 {
+	StopProfiler();
+	DumpTrace();
+	TraceStop();
+	traceMode = 0;
+	GoldenStop();
+	goldenMode = GOLDEN_OFF;
+	RewindFree();
+	rewindBuffer = 0;
+	free(runAheadState);
+	runAheadState = NULL;
+	bootCapture = false;
 	quit(0);
 }
 
-void retro_run(void)
+// One read of a joypad: a single RETRO_DEVICE_ID_JOYPAD_MASK query when
+// the frontend supports it, with edges found by XOR against the last read
+static void ReadJoypad(unsigned port, struct joypadState *pad)
 {
-	int c, i, j, k, l;
-	int showKeypad0 = false;
-	int showKeypad1 = false;
+	int buttons = 0;
+	unsigned id;
 
-	bool options_updated  = false;
-	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &options_updated) && options_updated)
-		check_variables(false);
+	if (inputBitmasks)
+		buttons = InputState(port, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_MASK) & 0xFFFF;
+	else
+	{
+		for (id = 0; id <= RETRO_DEVICE_ID_JOYPAD_R3; id++)
+		{
+			if (InputState(port, RETRO_DEVICE_JOYPAD, 0, id))
+				buttons |= 1 << id;
+		}
+	}
+	pad->pressed = (buttons ^ pad->buttons) & buttons;
+	pad->buttons = buttons;
+
+	pad->analog[0] = InputState(port, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_X);
+	pad->analog[1] = InputState(port, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_Y);
+	pad->analog[2] = InputState(port, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_X);
+	pad->analog[3] = InputState(port, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_Y);
+}
 
+// Sample the frontend's input and set the controller ports.  Called from
+// readMem on the first read of $1FE/$1FF in a frame, so the game sees
+// input polled as late as possible; retro_run calls it directly for
+// frames that don't read the ports.
+static void ReadInput(void)
+{
 	InputPoll();
+
+	ReadJoypad(0, &joypad[0]);
+	ReadJoypad(1, &joypad[1]);
+	read_pointer_input();
+
+	if (paused)
+		return;
+
+	// Process hotspot input directly - each hotspot assigned to its relative keypad button
+	process_hotspot_input();
 	
-	// DEBUG: Check pointer input at the start of retro_run and write to file
-	static int debug_frame_count = 0;
-	if (debug_frame_count < 300) {
-		int px = InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_X);
-		int py = InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_Y);
-		int pp = InputState(0, RETRO_DEVICE_POINTER, 0, RETRO_DEVICE_ID_POINTER_PRESSED);
-		
-		FILE *f = fopen("/storage/emulated/0/Download/freeintv_pointer_debug.txt", "a");
-		if (f) {
-			fprintf(f, "Frame %d: POINTER x=%d y=%d pressed=%d\n", debug_frame_count, px, py, pp);
-			fflush(f);
-			fclose(f);
+	// Process utility button input - map to RetroArch commands
+	process_utility_button_input();
+	
+	// Keep regular controller input for compatibility with non-overlay gameplay
+	// If no hotspot is pressed, fall back to standard controller input
+	int any_hotspot_pressed = 0;
+	for (int h = 0; h < OVERLAY_HOTSPOT_COUNT; h++)
+	{
+		if (hotspot_pressed[h])
+		{
+			any_hotspot_pressed = 1;
+			break;
 		}
-		debug_frame_count++;
 	}
+	
+	// If no hotspots pressed, handle regular controller input
+	if (!any_hotspot_pressed)
+	{
+		setControllerInput(0, getControllerState(&joypad[0], 0));
+	}
+
+	// Player 2 controller input (unchanged - no hotspot overlay for player 2)
+	if(joypad[1].buttons & (J_L|J_R)) // left shoulder down
+	{
+		showKeypad1 = true;
+		setControllerInput(1, getKeypadState(1, &joypad[1]));
+	}
+	else
+	{
+		showKeypad1 = false;
+		setControllerInput(1, getControllerState(&joypad[1], 1));
+	}
+
+	if(keyboardDown || keyboardChange)
+	{
+		setControllerInput(0, keyboardState);
+		keyboardChange = false;
+	}
+}
+
+static void LatchInput(void)
+{
+	PERF_BEGIN(PERF_INPUT);
+	ReadInput();
+	if (GoldenMode)
+		GoldenInput(&Memory[0x1FE]);
+	PERF_END(PERF_INPUT);
+}
+
+void retro_run(void)
+{
+	int c, i, j, k, l;
+	int samples, outSamples;
+	double ratio;
+	bool rewinding = false;
+	struct assetBatch *batch;
+	PERF_BEGIN(PERF_FRAME);
+
+	bool options_updated  = false;
+	if (Environ(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &options_updated) && options_updated)
+		check_variables(false);
 
-	for(i = 0; i < 20; i++) // Copy previous state
+	if (audioLatencyChange)
 	{
-		joypre0[i] = joypad0[i];
-		joypre1[i] = joypad1[i];
+		Environ(RETRO_ENVIRONMENT_SET_MINIMUM_AUDIO_LATENCY, &audioLatency);
+		audioLatencyChange = false;
 	}
 
-	/* JoyPad 0 */
-	joypad0[0] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP);
-	joypad0[1] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_DOWN);
-	joypad0[2] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT);
-	joypad0[3] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT);
-
-	joypad0[4] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_A);
-	joypad0[5] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B);
-	joypad0[6] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_X);
-	joypad0[7] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_Y);
-
-	joypad0[8] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_START);
-	joypad0[9] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_SELECT);
-
-	joypad0[10] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L);
-	joypad0[11] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R);
-	joypad0[12] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L2);
-	joypad0[13] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R2);
-
-	joypad0[14] = InputState(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_X);
-	joypad0[15] = InputState(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_Y);
-	joypad0[16] = InputState(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_X);
-	joypad0[17] = InputState(0, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_Y);
-	joypad0[18] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L3);
-	joypad0[19] = InputState(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R3);
-
-	/* JoyPad 1 */
-	joypad1[0] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_UP);
-	joypad1[1] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_DOWN);
-	joypad1[2] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_LEFT);
-	joypad1[3] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT);
-
-	joypad1[4] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_A);
-	joypad1[5] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_B);
-	joypad1[6] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_X);
-	joypad1[7] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_Y);
-
-	joypad1[8] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_START);
-	joypad1[9] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_SELECT);
-
-	joypad1[10] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L);
-	joypad1[11] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R);
-	joypad1[12] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L2);
-	joypad1[13] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R2);
-
-	joypad1[14] = InputState(1, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_X);
-	joypad1[15] = InputState(1, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_LEFT, RETRO_DEVICE_ID_ANALOG_Y);
-	joypad1[16] = InputState(1, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_X);
-	joypad1[17] = InputState(1, RETRO_DEVICE_ANALOG, RETRO_DEVICE_INDEX_ANALOG_RIGHT, RETRO_DEVICE_ID_ANALOG_Y);
-	joypad1[18] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_L3);
-	joypad1[19] = InputState(1, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_R3);
+	// swap in overlay images once the asset loader has them
+	batch = AssetsPoll();
+	if (batch)
+		install_overlay_assets(batch);
 
+	if (paused)
+		LatchInput(); // nothing reads the ports while paused
+	
 	// Pause
-	if((joypad0[8]==1 && joypre0[8]==0) || (joypad1[8]==1 && joypre1[8]==0))
+	if((joypad[0].pressed | joypad[1].pressed) & J_START)
 	{
 		paused = !paused;
 		if(paused)
@@ -1405,7 +1836,7 @@ void retro_run(void)
 	if(paused)
 	{
 		// help menu //
-		if(joypad0[4]==1 || joypad1[4]==1)
+		if((joypad[0].buttons | joypad[1].buttons) & J_A)
 		{
 			OSD_drawTextBG(3,  4, "                                      ");
 			OSD_drawTextBG(3,  5, "               - HELP -               ");
@@ -1426,61 +1857,46 @@ void retro_run(void)
 	}
 	else
 	{
-		// Process hotspot input directly - each hotspot assigned to its relative keypad button
-		process_hotspot_input();
-		
-		// Process utility button input - map to RetroArch commands
-		process_utility_button_input();
-		
-		// Keep regular controller input for compatibility with non-overlay gameplay
-		// If no hotspot is pressed, fall back to standard controller input
-		int any_hotspot_pressed = 0;
-		for (int h = 0; h < OVERLAY_HOTSPOT_COUNT; h++)
-		{
-			if (hotspot_pressed[h])
-			{
-				any_hotspot_pressed = 1;
-				break;
-			}
-		}
-		
-		// If no hotspots pressed, handle regular controller input
-		if (!any_hotspot_pressed)
-		{
-			setControllerInput(0, getControllerState(joypad0, 0));
-		}
+		// the controller ports are latched on their first read this frame
+		MemoryPortRead = 0;
 
-		// Player 2 controller input (unchanged - no hotspot overlay for player 2)
-		if(joypad1[10] | joypad1[11]) // left shoulder down
-		{
-			showKeypad1 = true;
-			setControllerInput(1, getKeypadState(1, joypad1, joypre1));
-		}
+		// step back through the in-core rewind history, or record this frame
+		if (rewindKey && RewindEnabled())
+			rewinding = RewindPop();
 		else
-		{
-			showKeypad1 = false;
-			setControllerInput(1, getControllerState(joypad1, 1));
-		}
+			RewindPush();
 
-		if(keyboardDown || keyboardChange)
+		// grab frame
 		{
-			setControllerInput(0, keyboardState);
-			keyboardChange = false;
+			PERF_BEGIN(PERF_RUN);
+			Run();
+			PERF_END(PERF_RUN);
 		}
+		if (intv_halt || TraceDiverged)
+			DumpTrace(); // keep the instructions that led up to it
+		if (!MemoryPortRead)
+			LatchInput(); // the game didn't read the ports this frame
 
-		// grab frame
-		Run();
-
-		// draw overlays
-		if(showKeypad0) { drawMiniKeypad(0, frame); }
-		if(showKeypad1) { drawMiniKeypad(1, frame); }
+		PERF_BEGIN(PERF_AUDIO);
 
 		// sample audio from buffer
-		audioInc = 3733.5 / audioSamples;
-		ivoiceInc = 1.0;
+		samples = frameSamples(intv_frames);
+		if (GoldenMode)
+			GoldenAudio(PSGBuffer, PSGBufferPos, ivoiceBuffer, samples);
+
+		ratio = 1.0;
+		if (audioRateControl && audioBufferActive)
+			ratio = 1.0 + AUDIO_RATE_CONTROL_DELTA * (50.0 - (double) audioBufferOccupancy) / 50.0;
+		audioOutputFrac += samples * ratio;
+		outSamples = (int) audioOutputFrac;
+		audioOutputFrac -= outSamples;
+
+		// stretch this frame's PSG and Intellivoice output over outSamples
+		audioInc = (double) PSGBufferPos / outSamples;
+		ivoiceInc = (double) samples / outSamples;
 
 		j = 0;
-		for(i=0; i<audioSamples; i++)
+		for(i=0; i<outSamples; i++)
 		{
 			// Sound interpolator:
 			//   The PSG module generates audio at 224010 hz (3733.5 samples per frame)
@@ -1494,11 +1910,15 @@ void retro_run(void)
 			c = 0;
 			while (j < k)
 				c += PSGBuffer[j++];
-			c = c / l;
+			if (l > 0)
+				c = c / l;
 			// Finally it adds the Intellivoice output (properly generated at the
 			// same frequency as output)
 			c = (c + ivoiceBuffer[(int) ivoiceBufferPos]) / 2;
 
+			if (rewinding)
+				c = 0; // frames replayed while rewinding are silent
+
 			Audio(c, c); // Audio(left, right)
 
 			ivoiceBufferPos += ivoiceInc;
@@ -1511,13 +1931,40 @@ void retro_run(void)
 		audioBufferPos = 0.0;
 		PSGFrame();
 		ivoiceBufferPos = 0.0;
-		ivoice_frame();
+		ivoice_frame(samples);
+		PERF_END(PERF_AUDIO);
+
+		if (bootCapture)
+		{
+			if (MemoryPortRead)
+				BootCacheSave();
+			else if (intv_frames >= BOOT_CAPTURE_FRAMES)
+				bootCapture = false;
+		}
+
+		if (stateHashLog)
+			LogInfo("[FREEINTV] Frame %u state hash %016llx\n", intv_frames, (unsigned long long) StateHash());
+		if (GoldenMode)
+			GoldenFrame(frame, frameSize);
+
+		if (runAhead > 0)
+		{
+			PERF_BEGIN(PERF_RUN);
+			MemoryPortRead = 1; // run-ahead frames reuse this frame's input
+			RunAhead(runAhead);
+			PERF_END(PERF_RUN);
+		}
+
+		// draw overlays
+		if(showKeypad0) { drawMiniKeypad(0, frame); }
+		if(showKeypad1) { drawMiniKeypad(1, frame); }
+		if(rewinding) { OSD_drawTextCenterBG(21, "REWIND"); }
 	}
 
 	// Swap Left/Right Controller
-	if(joypad0[9]==1 || joypad1[9]==1)
+	if((joypad[0].buttons | joypad[1].buttons) & J_SELECT)
 	{
-		if ((joypad0[9]==1 && joypre0[9]==0) || (joypad1[9]==1 && joypre1[9]==0))
+		if ((joypad[0].pressed | joypad[1].pressed) & J_SELECT)
 		{
 			controllerSwap = controllerSwap ^ 1;
 		}
@@ -1534,16 +1981,32 @@ void retro_run(void)
 	if (intv_halt)
 		OSD_drawTextBG(3, 5, "INTELLIVISION HALTED");
 	
+#ifdef PERF_TIMERS
+	if (perfHud)
+		PerfDrawHUD();
+#endif
+
 	// Render dual-screen display (game + keypad)
-	render_dual_screen();
+	{
+		PERF_BEGIN(PERF_RENDER);
+		render_dual_screen();
+		PERF_END(PERF_RENDER);
+	}
 	
 	// Send frame to libretro
 	if (dual_screen_enabled && dual_screen_buffer) {
-		Video(dual_screen_buffer, WORKSPACE_WIDTH, WORKSPACE_HEIGHT, sizeof(unsigned int) * WORKSPACE_WIDTH);
+		Video(dual_screen_buffer, WS(WORKSPACE_WIDTH), WS(WORKSPACE_HEIGHT), sizeof(unsigned int) * WS(WORKSPACE_WIDTH));
 	} else {
 		Video(frame, frameWidth, frameHeight, sizeof(unsigned int) * frameWidth);
 	}
 
+	PERF_END(PERF_FRAME);
+#ifdef PERF_TIMERS
+	PerfFrame();
+	if (perfLog && intv_frames % PERF_WINDOW == 0)
+		PerfLog();
+#endif
+	LogFlush();
 }
 
 unsigned retro_get_region(void)
@@ -1571,8 +2034,8 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 	
 	// Report dimensions based on dual-screen mode
 	if (dual_screen_enabled) {
-		info->geometry.base_width   = WORKSPACE_WIDTH;
-		info->geometry.base_height  = WORKSPACE_HEIGHT;
+		info->geometry.base_width   = WS(WORKSPACE_WIDTH);
+		info->geometry.base_height  = WS(WORKSPACE_HEIGHT);
 		info->geometry.max_width    = WORKSPACE_WIDTH;
 		info->geometry.max_height   = WORKSPACE_HEIGHT;
 		info->geometry.aspect_ratio = ((float)WORKSPACE_WIDTH) / ((float)WORKSPACE_HEIGHT);
@@ -1584,7 +2047,7 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 		info->geometry.aspect_ratio = ((float)MaxWidth) / ((float)MaxHeight);
 	}
 
-	info->timing.fps = DefaultFPS;
+	info->timing.fps = FRAME_RATE;
 	info->timing.sample_rate = AUDIO_FREQUENCY;
 
 	Environ(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixelformat);
@@ -1594,7 +2057,9 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 void retro_deinit(void)
 {
 	libretro_supports_option_categories = false;
+	AssetsShutdown();
 	quit(0);
+	LogFlush();
 }
 
 void retro_reset(void)
@@ -1609,6 +2074,10 @@ RETRO_API void *retro_get_memory_data(unsigned id)
 	{
 		return Memory;
 	}
+	if(id==RETRO_MEMORY_SAVE_RAM)
+	{
+		return JLPFlash();
+	}
 	return 0;
 }
 
@@ -1618,59 +2087,32 @@ RETRO_API size_t retro_get_memory_size(unsigned id)
 	{
 		return 0x10000;
 	}
+	if(id==RETRO_MEMORY_SAVE_RAM)
+	{
+		return JLPFlashWords() * sizeof(uint16_t);
+	}
 	return 0;
 }
 
-#define SERIALIZED_VERSION 0x4f544702
-
-struct serialized {
-	int version;
-	struct CP1610serialized CP1610;
-	struct STICserialized STIC;
-	struct PSGserialized PSG;
-	struct ivoiceSerialized ivoice;
-	unsigned int Memory[0x10000];   // Should be equal to Memory.c
-	// Extra variables from intv.c
-	int SR1;
-	int intv_halt;
-};
-
 size_t retro_serialize_size(void)
 {
-	return sizeof(struct serialized);
+	return StateMaxSize();
 }
 
 bool retro_serialize(void *data, size_t size)
 {
-	struct serialized *all;
-
-	all = (struct serialized *) data;
-	all->version = SERIALIZED_VERSION;
-	CP1610Serialize(&all->CP1610);
-	STICSerialize(&all->STIC);
-	PSGSerialize(&all->PSG);
-	ivoiceSerialize(&all->ivoice);
-	memcpy(all->Memory, Memory, sizeof(Memory));
-	all->SR1 = SR1;
-	all->intv_halt = intv_halt;
+	size_t used = StateSave(data, size, STATE_ALL);
+
+	if (used == 0)
+		return false;
+	// keep the unused tail deterministic for netplay/run-ahead compares
+	memset((char *) data + used, 0, size - used);
 	return true;
 }
 
 bool retro_unserialize(const void *data, size_t size)
 {
-	const struct serialized *all;
-
-	all = (const struct serialized *) data;
-	if (all->version != SERIALIZED_VERSION)
-		return false;
-	CP1610Unserialize(&all->CP1610);
-	STICUnserialize(&all->STIC);
-	PSGUnserialize(&all->PSG);
-	ivoiceUnserialize(&all->ivoice);
-	memcpy(Memory, all->Memory, sizeof(Memory));
-	SR1 = all->SR1;
-	intv_halt = all->intv_halt;
-	return true;
+	return StateLoad(data, size, STATE_ALL) != 0;
 }
 
 /* Stubs */
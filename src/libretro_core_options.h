@@ -55,6 +55,21 @@ struct retro_core_option_v2_category option_cats_us[] = {
       "Input",
       "Change controller settings."
    },
+   {
+      "audio",
+      "Audio",
+      "Change audio timing and latency settings."
+   },
+   {
+      "video",
+      "Video",
+      "Change the dual-screen display."
+   },
+   {
+      "system",
+      "System",
+      "Change emulation features such as rewind."
+   },
    { NULL, NULL, NULL },
 };
 
@@ -73,6 +88,190 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "right"
    },
+   {
+      "audio_rate_control",
+      "Dynamic Rate Control",
+      NULL,
+      "Adjust the number of audio samples produced each frame by up to 0.5% to keep the frontend audio buffer half full. Allows a lower audio latency without crackling. Requires frontend support for audio buffer status.",
+      NULL,
+      "audio",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "audio_latency",
+      "Minimum Audio Latency",
+      NULL,
+      "Request a minimum frontend audio buffer size in milliseconds. 'Default' leaves the frontend setting unchanged. Changing this may briefly reinitialize the audio driver.",
+      NULL,
+      "audio",
+      {
+         { "0",   "Default" },
+         { "16",  "16ms" },
+         { "32",  "32ms" },
+         { "48",  "48ms" },
+         { "64",  "64ms" },
+         { "96",  "96ms" },
+         { "128", "128ms" },
+         { NULL, NULL },
+      },
+      "0"
+   },
+   {
+      "run_ahead",
+      "Run-Ahead Frames",
+      NULL,
+      "Run hidden frames each frame to cut input latency, including touch keypad presses. Done inside the core and much cheaper than frontend run-ahead; do not enable both. Each frame of run-ahead adds one frame of emulation work.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "1", NULL },
+         { "2", NULL },
+         { "3", NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "state_hash_log",
+      "Log State Hash",
+      NULL,
+      "Print a 64-bit hash of the emulated machine state to the log after every frame. Two runs with the same input log the same hashes, which makes netplay desyncs and emulation regressions easy to spot.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+#ifdef PERF_TIMERS
+   {
+      "perf_timers",
+      "Frame Timing",
+      NULL,
+      "Show how long each part of a frame takes (min/avg/99th percentile over the last 128 frames, in milliseconds) on screen, or log it as one line every 128 frames for scripts. Only in builds made with PERF=1.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "hud", "On-Screen" },
+         { "log", "Log" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+#endif
+   {
+      "cpu_profiler",
+      "CPU Profiler",
+      NULL,
+      "Count instructions and cycles at every CP1610 address while the game runs. When the game is closed or this is turned off, a sorted report (<game>.profile.txt) and a callgrind file (callgrind.out.<game>) are written to the save folder, with labels taken from <game>.lst beside the ROM if there is one.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "cpu_trace",
+      "CPU Trace",
+      NULL,
+      "Record the registers and flags before each of the last 65536 CP1610 instructions. When the CPU halts, the game is closed or this is turned off, the trace is written to the save folder as <game>.trace.txt and, in jzIntv's debugger format for diffing, <game>.jzintv.txt. 'Verify' also checks every instruction against a reference trace in that format, <game>.ref.txt in the save folder or beside the ROM, and logs the first difference in registers, flags or cycles.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { "verify",   "Verify" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "golden",
+      "Golden Frames",
+      NULL,
+      "Regression check for the video and audio code, applied when a game is loaded. 'Record' writes <game>.golden.txt to the save folder with the controller input and a hash of the picture and sound for every frame. 'Verify' plays that input back in place of the controller and logs every frame whose picture or sound differs. Boot Snapshot Cache is ignored while either is on.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "record",   "Record" },
+         { "verify",   "Verify" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "boot_cache",
+      "Boot Snapshot Cache",
+      NULL,
+      "Save the machine to the save folder once the EXEC boot first reads the hand controllers, and restore that snapshot on later launches of the same cart instead of replaying the Mattel title sequence. Snapshots are tied to the cart and BIOS files.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "workspace_scale",
+      "Dual-Screen Output Size",
+      NULL,
+      "Size of the game and keypad image sent to the frontend. '1x' sends the game screen at its native resolution and the keypad shrunk to match, drawing a quarter of the pixels; use it when the frontend scales the picture anyway.",
+      NULL,
+      "video",
+      {
+         { "2", "2x (1074x600)" },
+         { "1", "1x (537x300)" },
+         { NULL, NULL },
+      },
+      "2"
+   },
+   {
+      "overlay_prefetch",
+      "Overlay Prefetch",
+      NULL,
+      "After a game loads, decode the overlay of the next game in the same folder in the background and keep it in the overlay cache in the save folder, so switching to that game shows the keypad sooner.",
+      NULL,
+      "system",
+      {
+         { "enabled", NULL },
+         { "disabled", NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "rewind_buffer",
+      "In-Core Rewind Buffer",
+      NULL,
+      "Keep a rewind history inside the core, stored as compressed differences between frames. Hold Backspace to step back one frame at a time. Use instead of frontend rewind on devices with little memory.",
+      NULL,
+      "system",
+      {
+         { "disabled", NULL },
+         { "4",   "4MB" },
+         { "8",   "8MB" },
+         { "16",  "16MB" },
+         { "32",  "32MB" },
+         { "64",  "64MB" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    { NULL, NULL, NULL, NULL, NULL, NULL, {{0}}, NULL },
 };
 
@@ -0,0 +1,112 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <windows.h>
+#endif
+#include "log.h"
+
+#define LOG_SLOTS 256 // power of two
+#define LOG_LINE  256
+
+// A slot is claimed by bumping head, filled, then published by setting
+// seq to its claim number plus one.  The reader only trusts slots whose
+// seq matches, so a half-written or overwritten slot is never shown.
+struct logSlot
+{
+	volatile unsigned int seq;
+	int level;
+	char text[LOG_LINE];
+};
+
+static struct logSlot ring[LOG_SLOTS];
+static volatile unsigned int head = 0; // next claim
+static unsigned int tail = 0; // next to drain
+static retro_log_printf_t logCallback = NULL;
+
+#if defined(__GNUC__)
+#define CLAIM()            __sync_fetch_and_add(&head, 1)
+#define PUBLISH(slot, n)   do { __sync_synchronize(); (slot)->seq = (n); } while (0)
+#define PUBLISHED(slot, n) ((slot)->seq == (n) && (__sync_synchronize(), 1))
+#elif defined(_MSC_VER)
+#define CLAIM()            ((unsigned int) InterlockedIncrement((volatile LONG *) &head) - 1)
+#define PUBLISH(slot, n)   ((slot)->seq = (n)) // volatile stores release on MSVC
+#define PUBLISHED(slot, n) ((slot)->seq == (n))
+#else
+#define CLAIM()            (head++) // no threads on these targets
+#define PUBLISH(slot, n)   ((slot)->seq = (n))
+#define PUBLISHED(slot, n) ((slot)->seq == (n))
+#endif
+
+void LogInit(retro_log_printf_t callback)
+{
+	logCallback = callback;
+}
+
+void LogWrite(int level, const char *format, ...)
+{
+	unsigned int n = CLAIM();
+	struct logSlot *slot = &ring[n & (LOG_SLOTS - 1)];
+	va_list args;
+
+	slot->seq = 0;
+	slot->level = level;
+	va_start(args, format);
+	vsnprintf(slot->text, LOG_LINE, format, args);
+	va_end(args);
+	PUBLISH(slot, n + 1);
+}
+
+static void emit(int level, const char *text)
+{
+	static const char *prefix[] = { "[DEBUG]", "[INFO]", "[WARN]", "[ERROR]" };
+
+	if (logCallback != NULL)
+		logCallback((enum retro_log_level) level, "%s", text);
+	else
+		printf("%s %s", prefix[level & 3], text);
+}
+
+void LogFlush(void)
+{
+	unsigned int end = head;
+	unsigned int dropped = 0;
+	struct logSlot *slot;
+	char note[64];
+
+	if (end - tail > LOG_SLOTS)
+	{
+		dropped = end - tail - LOG_SLOTS;
+		tail = end - LOG_SLOTS;
+	}
+	while (tail != end)
+	{
+		slot = &ring[tail & (LOG_SLOTS - 1)];
+		if (!PUBLISHED(slot, tail + 1))
+			break; // still being written, try again next flush
+		emit(slot->level, slot->text);
+		tail++;
+	}
+	if (dropped)
+	{
+		snprintf(note, sizeof(note), "[FREEINTV] %u log messages dropped\n", dropped);
+		emit(LOG_WARN, note);
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef LOG_H
+#define LOG_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "libretro.h"
+
+// Leveled logging through a lock-free ring.  LogWrite only formats into
+// a slot, so it is cheap on the game thread and safe from the asset
+// worker; LogFlush drains the ring on the game thread into the
+// frontend's log interface, or stdout when there is none.  If the ring
+// laps before a flush, the oldest messages are dropped and counted.
+
+// Same values as enum retro_log_level, but usable in #if
+#define LOG_DEBUG 0
+#define LOG_INFO  1
+#define LOG_WARN  2
+#define LOG_ERROR 3
+
+// Messages below LOG_LEVEL compile away; release builds drop debug
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL LOG_INFO
+#else
+#define LOG_LEVEL LOG_DEBUG
+#endif
+#endif
+
+#if LOG_LEVEL <= LOG_DEBUG
+#define LogDebug(...) LogWrite(LOG_DEBUG, __VA_ARGS__)
+#else
+#define LogDebug(...) ((void) 0)
+#endif
+
+#if LOG_LEVEL <= LOG_INFO
+#define LogInfo(...) LogWrite(LOG_INFO, __VA_ARGS__)
+#else
+#define LogInfo(...) ((void) 0)
+#endif
+
+#define LogWarn(...) LogWrite(LOG_WARN, __VA_ARGS__)
+#define LogError(...) LogWrite(LOG_ERROR, __VA_ARGS__)
+
+void LogInit(retro_log_printf_t callback); // NULL logs to stdout
+
+void LogWrite(int level, const char *format, ...);
+
+void LogFlush(void); // game thread only
+
+#endif
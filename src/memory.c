@@ -16,15 +16,115 @@
 	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 #include <stdio.h>
+#include <string.h>
 
 #include "intv.h"
 #include "memory.h"
 #include "stic.h"
 #include "psg.h"
 #include "ivoice.h"
+#include "jlp.h"
 
 unsigned int Memory[0x10000];
 
+int MemoryPortRead = 0;
+void (*MemoryPortHook)(void) = NULL;
+
+unsigned char MemoryMap[0x100];
+
+// page flipping, see MemoryAddPage()
+static const uint16_t *memPages[16][16];
+static const uint16_t *memPaged[16]; // selected page of each segment
+static int memPage[16];
+static int memPageMask[16]; // pages added to each segment
+
+// run-ahead checkpoint, see MemoryCheckpoint()
+static unsigned int cowMemory[0x10000];
+static unsigned char cowDirty[0x100];
+static int cowActive = 0;
+
+// Incremental hash over pages 0x02-0xFF, the XOR of memMix(adr, value)
+// for every word.  Pages 0x00-0x01 are written directly by the STIC, PSG
+// and controller code, so they are hashed when asked for.
+static uint64_t memHash;
+static int memHashValid = 0;
+#define HASH_FIRST_ADR 0x200
+
+static uint64_t memMix(int adr, unsigned int val)
+{
+    // splitmix64 finalizer
+    uint64_t z = (((uint64_t) adr << 32) | val) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t MemoryHash(void)
+{
+    uint64_t h = 0;
+    int adr;
+
+    if (!memHashValid) {
+        memHash = 0;
+        for (adr = HASH_FIRST_ADR; adr <= 0xFFFF; adr++)
+            memHash ^= memMix(adr, Memory[adr]);
+        memHashValid = 1;
+    }
+    for (adr = 0; adr < HASH_FIRST_ADR; adr++)
+        h ^= memMix(adr, Memory[adr]);
+    return h ^ memHash;
+}
+
+void MemoryHashInvalidate(void)
+{
+    memHashValid = 0;
+}
+
+// Pages 0x00-0x01 (STIC, scratch RAM, PSG, controllers) are also written
+// directly by the STIC, PSG and controller code, so they are always saved.
+#define COW_ALWAYS_PAGES 2
+
+static void cowTouch(int adr)
+{
+    int page = adr >> 8;
+    if (cowActive && !cowDirty[page]) {
+        memcpy(&cowMemory[page << 8], &Memory[page << 8], 0x100 * sizeof(unsigned int));
+        cowDirty[page] = 1;
+    }
+}
+
+// store a word, keeping the run-ahead checkpoint and hash current
+static void storeMem(int adr, unsigned int val)
+{
+    cowTouch(adr);
+    if (memHashValid && adr >= HASH_FIRST_ADR)
+        memHash ^= memMix(adr, Memory[adr]) ^ memMix(adr, val);
+    Memory[adr] = val;
+}
+
+void MemoryCheckpoint(void)
+{
+    memset(cowDirty, 0, sizeof(cowDirty));
+    memcpy(cowMemory, Memory, COW_ALWAYS_PAGES * 0x100 * sizeof(unsigned int));
+    memset(cowDirty, 1, COW_ALWAYS_PAGES);
+    cowActive = 1;
+}
+
+void MemoryRestore(void)
+{
+    int page, adr;
+    for (page = 0; page < 0x100; page++) {
+        if (cowDirty[page]) {
+            if (memHashValid && (page << 8) >= HASH_FIRST_ADR) {
+                for (adr = page << 8; adr < (page + 1) << 8; adr++)
+                    memHash ^= memMix(adr, Memory[adr]) ^ memMix(adr, cowMemory[adr]);
+            }
+            memcpy(&Memory[page << 8], &cowMemory[page << 8], 0x100 * sizeof(unsigned int));
+        }
+    }
+    cowActive = 0;
+}
+
 int stic_and[64] = {
     0x07ff, 0x07ff, 0x07ff, 0x07ff, 0x07ff, 0x07ff, 0x07ff, 0x07ff,
     0x0fff, 0x0fff, 0x0fff, 0x0fff, 0x0fff, 0x0fff, 0x0fff, 0x0fff,
@@ -47,46 +147,77 @@ int stic_or[64] = {
     0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff,
 };
 
+void MemoryAddPage(int segment, int page, const uint16_t *words)
+{
+    memPages[segment & 0xF][page & 0xF] = words;
+    memPageMask[segment & 0xF] |= 1 << (page & 0xF);
+    MemorySelectPage(segment, memPage[segment & 0xF]);
+}
+
+void MemorySelectPage(int segment, int page)
+{
+    segment &= 0xF;
+    page &= 0xF;
+    memPage[segment] = page;
+    memPaged[segment] = memPages[segment][page];
+}
+
+int MemoryGetPage(int segment)
+{
+    return memPage[segment & 0xF];
+}
+
+void MemoryResetPages(void)
+{
+    int segment;
+    for (segment = 0; segment < 16; segment++)
+        MemorySelectPage(segment, 0);
+}
+
 void writeMem(int adr, int val) // Write (should handle hooks/alias)
 {
     val &= 0xFFFF;
     adr &= 0xFFFF;
     
+    // ECS-style page flip: $xA5y to $xFFF of a segment with pages
+    if ((adr & 0x0FFF) == 0x0FFF && (val & 0x0FF0) == 0x0A50 && (val >> 12) == (adr >> 12) &&
+        memPageMask[adr >> 12] != 0) {
+        MemorySelectPage(adr >> 12, val & 0xF);
+        return;
+    }
+
     // Ignore writes to protected ROM spaces
     // Note: B17 Bomber manages to write on EXEC ROM (it will crash if unprotected)
-    switch (adr >> 11) {
-        case 0x02:  /* Exec ROM */
-        case 0x03:
-        case 0x06:  /* GROM */
-        case 0x0a:  /* 5000-57FF */
-        case 0x0b:  /* 5800-5FFF */
-        case 0x0c:  /* 6000-67FF */
-        case 0x0d:  /* 6800-6FFF */
-        case 0x14:  /* A000-A7FF */
-        case 0x15:  /* A800-AFFF */
-        case 0x16:  /* B000-B7FF */
-        case 0x1a:  /* D000-D7FF */
-        case 0x1b:  /* D800-DFFF */
-        case 0x1c:  /* E000-E7FF */
-        case 0x1d:  /* E800-EFFF */
-        case 0x1e:  /* F000-F7FF */
+    switch (MemoryMap[adr >> 8]) {
+        case MEM_ROM:
             return; /* Ignore */
-        case 0x07:  /* GRAM 3800-3fff */
-        case 0x0f:  /* GRAM 7800-7fff */
-        case 0x17:  /* GRAM B800-BFFF */
-        case 0x1f:  /* GRAM F800-FFFF */
+        case MEM_GRAM:
             if (stic_gram != 0) {
                 // GRAM is 8-bit memory
                 // Note: Without the AND 0xff, Tower of Doom fails as it builds
                 // map from GRAM.
-                Memory[adr & 0x39FF] = val & 0xff;
+                storeMem(adr & 0x39FF, val & 0xff);
             }
             return;
+        case MEM_RAM8:
+            val &= 0xff;
+            break;
+        case MEM_JLP:
+            if (JLPWrite(adr, val))
+                return;
+            break;
     }
     if (adr == 0x80 || adr == 0x81) {
         ivoice_wr(adr & 1, val);
         return;
     }
+    // ECS PSG and its I/O ports
+    if (adr >= 0xF0 && adr <= 0xFF && PSGHasECS()) {
+        Memory[adr] = val & 0xFF;
+        if (adr <= 0xFD)
+            PSGNotify(adr, val);
+        return;
+    }
     if(adr>=0x100 && adr<=0x1FF)
     {
         val = val & 0xFF;
@@ -114,7 +245,7 @@ void writeMem(int adr, int val) // Write (should handle hooks/alias)
         return;
     }
     
-    Memory[adr] = val;
+    storeMem(adr, val);
     
 }
 
@@ -125,6 +256,8 @@ int readMem(int adr) // Read (should handle hooks/alias)
     int val;
     
     adr &= 0xffff;
+    if (MemoryMap[adr >> 8] == MEM_JLP && JLPRead(adr, &val))
+        return val;
     if (adr == 0x80 || adr == 0x81)
         return ivoice_rd(adr & 1);
     // STIC access
@@ -139,19 +272,60 @@ int readMem(int adr) // Read (should handle hooks/alias)
         val = (Memory[adr] & stic_and[adr]) | stic_or[adr];
         return val;
 	}
+    if (memPaged[adr >> 12] != NULL)
+        return memPaged[adr >> 12][adr & 0xFFF];
     val = Memory[adr];
 
 	if(adr>=0x100 && adr<=0x1FF)
 	{
 		val = val & 0xFF;
+		if(adr>=0x1FE && !MemoryPortRead)
+		{
+			MemoryPortRead = 1;
+			if(MemoryPortHook) { MemoryPortHook(); }
+			val = Memory[adr] & 0xFF;
+		}
 	}
 
 	return val;
 }
 
+int MemoryPeek(int adr)
+{
+	adr &= 0xffff;
+	if (memPaged[adr >> 12] != NULL)
+		return memPaged[adr >> 12][adr & 0xFFF];
+	return Memory[adr];
+}
+
+void MemoryMapRange(int first, int last, int attr)
+{
+	int page;
+	for(page=(first>>8)&0xFF; page<=((last>>8)&0xFF); page++)
+	{
+		if(attr!=MEM_ROM || MemoryMap[page]!=MEM_GRAM)
+		{
+			MemoryMap[page] = attr;
+		}
+	}
+}
+
 void MemoryInit()
 {
 	int i;
+	MemoryHashInvalidate();
+	memset(MemoryMap, MEM_RAM, sizeof(MemoryMap));
+	memset(memPages, 0, sizeof(memPages));
+	memset(memPage, 0, sizeof(memPage));
+	memset(memPageMask, 0, sizeof(memPageMask));
+	memset(memPaged, 0, sizeof(memPaged));
+	MemoryMapRange(0x0100, 0x01FF, MEM_RAM8); // Scratch, PSG, controllers
+	MemoryMapRange(0x1000, 0x1FFF, MEM_ROM);  // EXEC
+	MemoryMapRange(0x3000, 0x37FF, MEM_ROM);  // GROM
+	for(i=0x3800; i<=0xFFFF; i+=0x4000) { MemoryMapRange(i, i+0x7FF, MEM_GRAM); }
+	MemoryMapRange(0x5000, 0x6FFF, MEM_ROM);  // default cart space
+	MemoryMapRange(0xA000, 0xB7FF, MEM_ROM);
+	MemoryMapRange(0xD000, 0xF7FF, MEM_ROM);
 	for(i=0x0000; i<=0x0007; i++) { Memory[i] = 0x3800; } // STIC Registers
 	for(i=0x0008; i<=0x000F; i++) { Memory[i] = 0x3000; }
 	for(i=0x0010; i<=0x0017; i++) { Memory[i] = 0x0000; }
@@ -18,12 +18,65 @@
 	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <stdint.h>
+
 extern unsigned int Memory[0x10000];
 
+// Attributes of each 256-word page, used by writeMem.  MemoryInit sets
+// up the bare console; the cart loader adds ROM and RAM on top.
+#define MEM_RAM  0 // 16-bit read/write
+#define MEM_ROM  1 // writes ignored
+#define MEM_RAM8 2 // 8-bit read/write
+#define MEM_GRAM 3 // alias, writes go to GRAM at $3800
+#define MEM_JLP  4 // 16-bit RAM with JLP registers, see jlp.h
+
+extern unsigned char MemoryMap[0x100];
+
 void MemoryInit(void);
 
+// Set the attribute of the pages covering first-last.  ROM is never
+// mapped over the GRAM aliases.
+void MemoryMapRange(int first, int last, int attr);
+
+// ECS-style page flipping: writing $xA5y to $xFFF selects page y of 4K
+// segment x.  Reads from a segment with a page selected come from that
+// page's 0x1000 words instead of Memory, so a flip only swaps a pointer.
+// Pages that were never added read through to Memory.
+void MemoryAddPage(int segment, int page, const uint16_t *words);
+
+void MemorySelectPage(int segment, int page);
+
+int MemoryGetPage(int segment);
+
+void MemoryResetPages(void); // select page 0 everywhere
+
 int readMem(int adr);
 
+// The word the CPU would fetch from adr, without readMem's side effects
+// (JLP, Intellivoice and STIC registers, the hand controller hook).
+// Used to read instruction operands for the trace.
+int MemoryPeek(int adr);
+
+// readMem sets MemoryPortRead on a read of the hand controller ports
+// ($1FE/$1FF); the first such read after it is cleared calls
+// MemoryPortHook, so the frontend can sample input just in time.
+extern int MemoryPortRead;
+extern void (*MemoryPortHook)(void);
+
 void writeMem(int adr, int val);
 
+// Copy-on-write checkpoint used by run-ahead: after MemoryCheckpoint,
+// the first write to each 256-word page saves a copy of it, and
+// MemoryRestore puts back only the pages written since.
+void MemoryCheckpoint(void);
+
+void MemoryRestore(void);
+
+// 64-bit hash of all of Memory.  Kept up to date by writeMem; code that
+// fills Memory directly (loaders, savestates) calls MemoryHashInvalidate
+// and the next MemoryHash rebuilds it.
+uint64_t MemoryHash(void);
+
+void MemoryHashInvalidate(void);
+
 #endif
@@ -0,0 +1,163 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#ifdef PERF_TIMERS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "perf.h"
+#include "osd.h"
+#include "log.h"
+
+static const char *names[PERF_COUNT] =
+{
+	"FRAME", "RUN", "STIC", "PSG", "IVOICE", "AUDIO", "RENDER", "INPUT"
+};
+
+static uint64_t total[PERF_COUNT]; // this frame
+static uint64_t window[PERF_COUNT][PERF_WINDOW]; // past frames
+static unsigned int frames = 0;
+
+uint64_t PerfNow(void)
+{
+#if defined(_WIN32)
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64_t) ((double) now.QuadPart * 1e9 / (double) freq.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#else
+	return (uint64_t) clock() * (1000000000u / CLOCKS_PER_SEC);
+#endif
+}
+
+void PerfAdd(int id, uint64_t ns)
+{
+	total[id] += ns;
+}
+
+// Time between two back-to-back PerfNow calls, the least of a few tries
+static uint64_t clockCost(void)
+{
+	static int measured = 0;
+	static uint64_t cost;
+	uint64_t start, ns;
+	int i;
+
+	if (!measured)
+	{
+		cost = UINT64_MAX;
+		for (i = 0; i < 16; i++)
+		{
+			start = PerfNow();
+			ns = PerfNow() - start;
+			if (ns < cost)
+				cost = ns;
+		}
+		measured = 1;
+	}
+	return cost;
+}
+
+void PerfAddSample(int id, uint64_t ns)
+{
+	uint64_t cost = clockCost();
+	total[id] += (ns > cost ? ns - cost : 0) * PERF_SAMPLE;
+}
+
+void PerfFrame(void)
+{
+	int i;
+	for (i = 0; i < PERF_COUNT; i++)
+	{
+		window[i][frames % PERF_WINDOW] = total[i];
+		total[i] = 0;
+	}
+	frames++;
+}
+
+static int compare(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a;
+	uint64_t y = *(const uint64_t *) b;
+	return (x > y) - (x < y);
+}
+
+void PerfStats(int id, struct perfStats *stats)
+{
+	uint64_t sorted[PERF_WINDOW];
+	uint64_t sum = 0;
+	int n = frames < PERF_WINDOW ? frames : PERF_WINDOW;
+	int i;
+
+	memset(stats, 0, sizeof(*stats));
+	if (n == 0)
+		return;
+	memcpy(sorted, window[id], n * sizeof(uint64_t));
+	qsort(sorted, n, sizeof(uint64_t), compare);
+	for (i = 0; i < n; i++)
+		sum += sorted[i];
+	stats->min = sorted[0] / 1e6;
+	stats->avg = sum / (double) n / 1e6;
+	stats->p99 = sorted[(n - 1) * 99 / 100] / 1e6;
+}
+
+void PerfDrawHUD(void)
+{
+	struct perfStats stats;
+	char line[64];
+	int i;
+
+	snprintf(line, sizeof(line), "%-6s %6s %6s %6s ", "MS", "MIN", "AVG", "P99");
+	OSD_drawTextBG(1, 1, line);
+	for (i = 0; i < PERF_COUNT; i++)
+	{
+		PerfStats(i, &stats);
+		snprintf(line, sizeof(line), "%-6s %6.2f %6.2f %6.2f ", names[i], stats.min, stats.avg, stats.p99);
+		OSD_drawTextBG(1, 2 + i, line);
+	}
+}
+
+void PerfLog(void)
+{
+	struct perfStats stats;
+	char line[512];
+	int len, i;
+
+	// perf frames=N name=min/avg/p99 ..., times in milliseconds
+	len = snprintf(line, sizeof(line), "[FREEINTV] perf frames=%u", frames);
+	for (i = 0; i < PERF_COUNT && len < (int) sizeof(line); i++)
+	{
+		PerfStats(i, &stats);
+		len += snprintf(line + len, sizeof(line) - len, " %s=%.3f/%.3f/%.3f",
+			names[i], stats.min, stats.avg, stats.p99);
+	}
+	LogInfo("%s\n", line);
+}
+
+#endif
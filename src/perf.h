@@ -0,0 +1,78 @@
+#ifndef PERF_H
+#define PERF_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdint.h>
+
+// Frame timing for the main subsystems, compiled in with PERF_TIMERS
+// (make PERF=1) and free otherwise.  Time between PERF_BEGIN and
+// PERF_END is added to that subsystem's total for the frame; PerfFrame
+// closes the frame and keeps the last PERF_WINDOW totals, which are
+// reported as min/avg/p99.  Timers nest: RUN includes STIC, PSG, IVOICE
+// and INPUT, and FRAME includes everything.
+
+enum
+{
+	PERF_FRAME,  // all of retro_run
+	PERF_RUN,    // emulation, including run-ahead frames
+	PERF_STIC,   // STICDrawFrame
+	PERF_PSG,    // PSGTick
+	PERF_IVOICE, // ivoice_tk
+	PERF_AUDIO,  // resampling to the frontend rate
+	PERF_RENDER, // render_dual_screen
+	PERF_INPUT,  // LatchInput
+	PERF_COUNT
+};
+
+#define PERF_WINDOW 128 // frames
+#define PERF_SAMPLE 64 // per-instruction work times one call in this many
+
+#ifdef PERF_TIMERS
+
+#define PERF_BEGIN(id) uint64_t perfStart_##id = PerfNow()
+#define PERF_END(id) PerfAdd(id, PerfNow() - perfStart_##id)
+
+struct perfStats
+{
+	double min, avg, p99; // milliseconds per frame
+};
+
+uint64_t PerfNow(void); // nanoseconds, arbitrary origin
+
+void PerfAdd(int id, uint64_t ns);
+
+// One timed call out of PERF_SAMPLE: the cost of reading the clock is
+// taken off and the rest counted PERF_SAMPLE times
+void PerfAddSample(int id, uint64_t ns);
+
+void PerfFrame(void); // end of frame, commit the totals
+
+void PerfStats(int id, struct perfStats *stats);
+
+void PerfDrawHUD(void); // draw the table on the game frame with the OSD font
+
+void PerfLog(void); // log one machine-readable line
+
+#else
+
+#define PERF_BEGIN(id) ((void) 0)
+#define PERF_END(id) ((void) 0)
+
+#endif
+
+#endif
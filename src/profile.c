@@ -0,0 +1,396 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "cp1610.h"
+#include "profile.h"
+#include "log.h"
+#include "file/file_path.h"
+
+#define REPORT_ADDRESSES 64
+#define SYMBOL_LEN 32
+
+int ProfileEnabled = 0;
+
+struct counters
+{
+	uint64_t pcCount[0x10000];
+	uint64_t pcCycles[0x10000];
+	uint64_t opCount[0x400];
+	uint64_t opCycles[0x400];
+};
+
+static struct counters *counts = NULL;
+
+struct symbol
+{
+	unsigned int addr;
+	int local; // name.label or @@label
+	char name[SYMBOL_LEN];
+};
+
+static struct symbol *symbols = NULL;
+static int symbolCount = 0;
+static uint8_t *listed = NULL; // addresses the listing has code or data for
+
+int ProfileStart(void)
+{
+	if (counts == NULL)
+		counts = (struct counters *) malloc(sizeof(*counts));
+	if (counts == NULL)
+		return 0;
+	memset(counts, 0, sizeof(*counts));
+	ProfileEnabled = 1;
+	return 1;
+}
+
+void ProfileCount(unsigned int pc, unsigned int opcode, int ticks)
+{
+	pc &= 0xFFFF;
+	counts->pcCount[pc]++;
+	counts->pcCycles[pc] += ticks;
+	counts->opCount[opcode]++;
+	counts->opCycles[opcode] += ticks;
+}
+
+// Listing symbols
+
+static int hexRun(const char *s)
+{
+	int n = 0;
+	while (isxdigit((unsigned char) s[n]))
+		n++;
+	return n;
+}
+
+static int compareSymbols(const void *a, const void *b)
+{
+	const struct symbol *x = (const struct symbol *) a;
+	const struct symbol *y = (const struct symbol *) b;
+	if (x->addr != y->addr)
+		return x->addr < y->addr ? -1 : 1;
+	return x->local - y->local; // globals first at the same address
+}
+
+// as1600 listings start with a table of "%08x NAME" pairs, followed by
+// source lines that start with a 4 digit address and the words there
+static int loadSymbols(const char *lstPath)
+{
+	char line[512], name[SYMBOL_LEN];
+	struct symbol *all = NULL;
+	int count = 0, size = 0, i, n;
+	unsigned int addr;
+	const char *p;
+	FILE *fp;
+
+	if ((fp = fopen(lstPath, "r")) == NULL)
+		return 0;
+	listed = (uint8_t *) calloc(0x10000, 1);
+	if (listed == NULL)
+	{
+		fclose(fp);
+		return 0;
+	}
+
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		n = hexRun(line);
+		if (n == 4 && line[4] == ' ' && hexRun(line + 5) == 4)
+		{
+			sscanf(line, "%4x", &addr);
+			listed[addr & 0xFFFF] = 1;
+			continue;
+		}
+		for (p = line; hexRun(p) == 8 && sscanf(p, "%8x %31s%n", &addr, name, &n) == 2; p += n)
+		{
+			if (count == size)
+			{
+				struct symbol *grown;
+				size = size ? size * 2 : 256;
+				grown = (struct symbol *) realloc(all, size * sizeof(*all));
+				if (grown == NULL)
+					break;
+				all = grown;
+			}
+			all[count].addr = addr & 0xFFFF;
+			all[count].local = strchr(name, '.') != NULL || name[0] == '@';
+			strcpy(all[count].name, name);
+			count++;
+			while (*(p + n) == ' ' || *(p + n) == '\t')
+				n++;
+		}
+	}
+	fclose(fp);
+
+	// only labels on listed addresses; equates and RAM variables would
+	// otherwise claim the EXEC and the cart's own data
+	symbols = all;
+	symbolCount = 0;
+	for (i = 0; i < count; i++)
+		if (listed[all[i].addr])
+			symbols[symbolCount++] = all[i];
+	qsort(symbols, symbolCount, sizeof(*symbols), compareSymbols);
+	LogInfo("[FREEINTV] Profiler: %i symbols from %s\n", symbolCount, lstPath);
+	return 1;
+}
+
+static void freeSymbols(void)
+{
+	free(symbols);
+	free(listed);
+	symbols = NULL;
+	listed = NULL;
+	symbolCount = 0;
+}
+
+// Nearest label at or below pc, or NULL outside the listing
+static const struct symbol *findSymbol(unsigned int pc, int globalOnly)
+{
+	int lo = 0, hi = symbolCount - 1, mid, best = -1;
+
+	if (listed == NULL || !listed[pc])
+		return NULL;
+	while (lo <= hi)
+	{
+		mid = (lo + hi) / 2;
+		if (symbols[mid].addr <= pc)
+		{
+			best = mid;
+			lo = mid + 1;
+		}
+		else
+			hi = mid - 1;
+	}
+	while (best >= 0 && globalOnly && symbols[best].local)
+		best--;
+	return best >= 0 ? &symbols[best] : NULL;
+}
+
+static void describe(char *out, size_t size, unsigned int pc)
+{
+	const struct symbol *s = findSymbol(pc, 0);
+	if (s == NULL)
+		snprintf(out, size, "$%04X", pc);
+	else if (s->addr == pc)
+		snprintf(out, size, "%s", s->name);
+	else
+		snprintf(out, size, "%s+%u", s->name, pc - s->addr);
+}
+
+// Reports
+
+struct row
+{
+	const char *name;
+	unsigned int key;
+	uint64_t count, cycles;
+};
+
+static int compareRows(const void *a, const void *b)
+{
+	const struct row *x = (const struct row *) a;
+	const struct row *y = (const struct row *) b;
+	if (x->cycles != y->cycles)
+		return x->cycles > y->cycles ? -1 : 1;
+	return (x->key > y->key) - (x->key < y->key);
+}
+
+// Fold rows with the same name together; returns the new row count
+static int foldRows(struct row *rows, int n)
+{
+	int i, j, out = 0;
+	for (i = 0; i < n; i++)
+	{
+		for (j = 0; j < out; j++)
+			if (strcmp(rows[j].name, rows[i].name) == 0)
+				break;
+		if (j == out)
+			rows[out++] = rows[i];
+		else
+		{
+			rows[j].count += rows[i].count;
+			rows[j].cycles += rows[i].cycles;
+		}
+	}
+	return out;
+}
+
+static void writeRows(FILE *fp, const char *title, struct row *rows, int n, int limit, uint64_t cycles)
+{
+	int i;
+	qsort(rows, n, sizeof(*rows), compareRows);
+	fprintf(fp, "\n%s\n%-28s %12s %14s %7s\n", title, "", "instructions", "cycles", "%");
+	for (i = 0; i < n && i < limit && rows[i].cycles > 0; i++)
+		fprintf(fp, "%-28s %12llu %14llu %6.2f%%\n", rows[i].name, (unsigned long long) rows[i].count,
+			(unsigned long long) rows[i].cycles, cycles ? 100.0 * rows[i].cycles / cycles : 0.0);
+}
+
+static void writeReport(FILE *fp, const char *romPath)
+{
+	char (*names)[SYMBOL_LEN + 8] = malloc(0x10000 * sizeof(*names));
+	struct row *rows = (struct row *) malloc(0x10000 * sizeof(*rows));
+	uint64_t instructions = 0, cycles = 0;
+	const struct symbol *s;
+	int i, n;
+
+	if (names == NULL || rows == NULL)
+	{
+		free(names);
+		free(rows);
+		return;
+	}
+
+	for (i = 0; i < 0x400; i++)
+	{
+		instructions += counts->opCount[i];
+		cycles += counts->opCycles[i];
+	}
+	fprintf(fp, "FreeIntv CPU profile: %s\n%llu instructions, %llu cycles\n", romPath,
+		(unsigned long long) instructions, (unsigned long long) cycles);
+
+	// opcode classes, by mnemonic
+	for (i = 0; i < 0x400; i++)
+	{
+		rows[i].name = Nmemonic[i];
+		rows[i].key = i;
+		rows[i].count = counts->opCount[i];
+		rows[i].cycles = counts->opCycles[i];
+	}
+	n = foldRows(rows, 0x400);
+	writeRows(fp, "Opcode classes", rows, n, n, cycles);
+
+	// routines, by nearest global label
+	n = 0;
+	for (i = 0; i < 0x10000; i++)
+	{
+		if (counts->pcCount[i] == 0)
+			continue;
+		s = findSymbol(i, 1);
+		rows[n].name = s ? s->name : (i >= 0x1000 && i < 0x2000 ? "(exec)" : "(unknown)");
+		rows[n].key = i;
+		rows[n].count = counts->pcCount[i];
+		rows[n].cycles = counts->pcCycles[i];
+		n++;
+	}
+	n = foldRows(rows, n);
+	writeRows(fp, "Routines", rows, n, n, cycles);
+
+	// hottest addresses
+	n = 0;
+	for (i = 0; i < 0x10000; i++)
+	{
+		if (counts->pcCount[i] == 0)
+			continue;
+		describe(names[i], sizeof(names[i]), i);
+		if (strncmp(names[i], "$", 1) != 0)
+		{
+			size_t len = strlen(names[i]);
+			snprintf(names[i] + len, sizeof(names[i]) - len, " $%04X", i);
+		}
+		rows[n].name = names[i];
+		rows[n].key = i;
+		rows[n].count = counts->pcCount[i];
+		rows[n].cycles = counts->pcCycles[i];
+		n++;
+	}
+	writeRows(fp, "Addresses", rows, n, REPORT_ADDRESSES, cycles);
+	free(names);
+	free(rows);
+}
+
+// callgrind format with instruction positions, one fn per routine
+static void writeCallgrind(FILE *fp, const char *romPath, const char *lstPath)
+{
+	const struct symbol *s, *last = (const struct symbol *) -1;
+	int i;
+
+	fprintf(fp, "version: 1\ncreator: FreeIntv\ncmd: %s\npositions: instr\nevents: Ir Cycles\n\n", romPath);
+	fprintf(fp, "ob=%s\nfl=%s\n", path_basename(romPath), symbols ? lstPath : "???");
+	for (i = 0; i < 0x10000; i++)
+	{
+		if (counts->pcCount[i] == 0)
+			continue;
+		s = findSymbol(i, 1);
+		if (s != last)
+		{
+			if (s)
+				fprintf(fp, "fn=%s\n", s->name);
+			else
+				fprintf(fp, "fn=%s\n", i >= 0x1000 && i < 0x2000 ? "(exec)" : "(unknown)");
+			last = s;
+		}
+		fprintf(fp, "0x%04X %llu %llu\n", i, (unsigned long long) counts->pcCount[i],
+			(unsigned long long) counts->pcCycles[i]);
+	}
+}
+
+void ProfileStop(const char *romPath, const char *outDir)
+{
+	char lstPath[1024] = "", dir[1024], base[256], name[300], out[1024];
+	FILE *fp;
+
+	if (!ProfileEnabled)
+		return;
+	ProfileEnabled = 0;
+	if (counts == NULL)
+		return;
+
+	if (romPath != NULL && romPath[0] != '\0')
+	{
+		// <rom>.lst, then src/<rom>.lst
+		fill_pathname_basedir(dir, romPath, sizeof(dir));
+		fill_pathname_base_noext(base, romPath, sizeof(base));
+		snprintf(name, sizeof(name), "%s.lst", base);
+		fill_pathname_join(lstPath, dir, name, sizeof(lstPath));
+		if (!loadSymbols(lstPath))
+		{
+			snprintf(name, sizeof(name), "src/%s.lst", base);
+			fill_pathname_join(lstPath, dir, name, sizeof(lstPath));
+			loadSymbols(lstPath);
+		}
+	}
+	else
+	{
+		romPath = "";
+		strcpy(base, "FreeIntv");
+	}
+
+	snprintf(name, sizeof(name), "%s.profile.txt", base);
+	fill_pathname_join(out, outDir, name, sizeof(out));
+	if ((fp = fopen(out, "w")) != NULL)
+	{
+		writeReport(fp, romPath);
+		fclose(fp);
+		LogInfo("[FREEINTV] Profiler: wrote %s\n", out);
+	}
+	snprintf(name, sizeof(name), "callgrind.out.%s", base);
+	fill_pathname_join(out, outDir, name, sizeof(out));
+	if ((fp = fopen(out, "w")) != NULL)
+	{
+		writeCallgrind(fp, romPath, lstPath);
+		fclose(fp);
+		LogInfo("[FREEINTV] Profiler: wrote %s\n", out);
+	}
+
+	freeSymbols();
+	free(counts);
+	counts = NULL;
+}
@@ -0,0 +1,35 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// CP1610 profiler: counts instructions and cycles per PC address and per
+// opcode, in flat 64K and 1K entry tables.  ProfileStop writes a sorted
+// text report and a callgrind file (kcachegrind, callgrind_annotate),
+// with addresses named from the cart's assembler listing when one sits
+// next to the ROM as <name>.lst or src/<name>.lst.
+
+extern int ProfileEnabled;
+
+int ProfileStart(void); // clear the counters and start counting, 0 if out of memory
+
+void ProfileCount(unsigned int pc, unsigned int opcode, int ticks); // after each instruction
+
+void ProfileStop(const char *romPath, const char *outDir); // write the reports and free the counters
+
+#endif
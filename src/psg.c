@@ -27,29 +27,27 @@ int Volume[16] = { 0, 92, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072,
 int Envelope_Shift[4] = {8, 2, 1, 0};
 
 // Volume levels assigned to each channel from PSG registers
-#define VolA    (Memory[0x01FB] & 0x0F)
-#define VolB    (Memory[0x01FC] & 0x0F)
-#define VolC    (Memory[0x01FD] & 0x0F)
+#define VolA    (p->Reg[0xB] & 0x0F)
+#define VolB    (p->Reg[0xC] & 0x0F)
+#define VolC    (p->Reg[0xD] & 0x0F)
 
 // Envelope shifts for channels (6-bit variations only)
-#define EnvA    ((Memory[0x01FB] >> 4) & 0x03)
-#define EnvB    ((Memory[0x01FC] >> 4) & 0x03)
-#define EnvC    ((Memory[0x01FD] >> 4) & 0x03)
-
-int NoiseP; // Noise Period
+#define EnvA    ((p->Reg[0xB] >> 4) & 0x03)
+#define EnvB    ((p->Reg[0xC] >> 4) & 0x03)
+#define EnvC    ((p->Reg[0xD] >> 4) & 0x03)
 
 // Detect Tone enabled for this channel (0- enabled, 1- disabled)
-#define ToneA   ((Memory[0x01F8] & 0x01) != 0)
-#define ToneB   ((Memory[0x01F8] & 0x02) != 0)
-#define ToneC   ((Memory[0x01F8] & 0x04) != 0)
+#define ToneA   ((p->Reg[0x8] & 0x01) != 0)
+#define ToneB   ((p->Reg[0x8] & 0x02) != 0)
+#define ToneC   ((p->Reg[0x8] & 0x04) != 0)
            
 // Detect Noise enabled for this channel (0- enabled, 1- disabled)
-#define NoiseA  ((Memory[0x01F8] & 0x08) != 0)
-#define NoiseB  ((Memory[0x01F8] & 0x10) != 0)
-#define NoiseC  ((Memory[0x01F8] & 0x20) != 0)
+#define NoiseA  ((p->Reg[0x8] & 0x08) != 0)
+#define NoiseB  ((p->Reg[0x8] & 0x10) != 0)
+#define NoiseC  ((p->Reg[0x8] & 0x20) != 0)
 
 // Envelope type
-#define EnvFlags    (Memory[0x01FA] & 0x0F)
+#define EnvFlags    (p->Reg[0xA] & 0x0F)
 
 int PSGBufferSize;
 int16_t PSGBuffer[7467];
@@ -57,128 +55,78 @@ int PSGBufferPos;
 
 int Ticks; // CPU cycles not yet processed
 
-int CountA; // countdowns for tone generators
-int CountB; // used to modulate square-wave
-int CountC; // according to Channel Period
-int CountN; // countdown for noise generator
-int CountE; // countdown for envelope generator
-
-int OutA; // outputs for each tone generator
-int OutB;
-int OutC;
-int OutN;  // Noise generator output
-int OutE;  // Envelope generator output
-
-int ChA; // Channel Period from PSG Registers
-int ChB;
-int ChC;
-
-int EnvP;    // Envelope Period
-int StepE; // 1, 0, -1 -- Direction to Step Envelope at end of countdown
-
-int EnvContinue; // Flags from Envelope Type
-int EnvAttack;
-int EnvAlternate;
-int EnvHold;
+static struct PSG psg[2]; // console, ECS
+static int ecs; // ECS PSG present
 
 void PSGSerialize(struct PSGserialized *all)
 {
     all->PSGBufferSize = PSGBufferSize;
-    memcpy(all->PSGBuffer, PSGBuffer, sizeof(PSGBuffer));
     all->PSGBufferPos = PSGBufferPos;
     all->Ticks = Ticks;
-    all->CountA = CountA;
-    all->CountB = CountB;
-    all->CountC = CountC;
-    all->CountN = CountN;
-    all->CountE = CountE;
-    all->OutA = OutA;
-    all->OutB = OutB;
-    all->OutC = OutC;
-    all->OutN = OutN;
-    all->OutE = OutE;
-    all->ChA = ChA;
-    all->ChB = ChB;
-    all->ChC = ChC;
-    all->NoiseP = NoiseP;
-    all->EnvP = EnvP;
-    all->StepE = StepE;
-    all->EnvContinue = EnvContinue;
-    all->EnvAttack = EnvAttack;
-    all->EnvAlternate = EnvAlternate;
-    all->EnvHold = EnvHold;
+    all->ECS = ecs;
+    memcpy(all->psg, psg, sizeof(psg));
 }
 
 void PSGUnserialize(const struct PSGserialized *all)
 {
     PSGBufferSize = all->PSGBufferSize;
-    memcpy(PSGBuffer, all->PSGBuffer, sizeof(PSGBuffer));
     PSGBufferPos = all->PSGBufferPos;
     Ticks = all->Ticks;
-    CountA = all->CountA;
-    CountB = all->CountB;
-    CountC = all->CountC;
-    CountN = all->CountN;
-    CountE = all->CountE;
-    OutA = all->OutA;
-    OutB = all->OutB;
-    OutC = all->OutC;
-    OutN = all->OutN;
-    OutE = all->OutE;
-    ChA = all->ChA;
-    ChB = all->ChB;
-    ChC = all->ChC;
-    NoiseP = all->NoiseP;
-    EnvP = all->EnvP;
-    StepE = all->StepE;
-    EnvContinue = all->EnvContinue;
-    EnvAttack = all->EnvAttack;
-    EnvAlternate = all->EnvAlternate;
-    EnvHold = all->EnvHold;
+    ecs = all->ECS;
+    memcpy(psg, all->psg, sizeof(psg));
 }
 
-void readRegisters(void)
+static void readRegisters(struct PSG *p)
 {
-	ChA = (Memory[0x01F0] & 0xFF) | ((Memory[0x1F4] & 0x0F)<<8);
-	ChB = (Memory[0x01F1] & 0xFF) | ((Memory[0x1F5] & 0x0F)<<8);
-	ChC = (Memory[0x01F2] & 0xFF) | ((Memory[0x1F6] & 0x0F)<<8);
+	p->ChA = (p->Reg[0x0] & 0xFF) | ((p->Reg[0x4] & 0x0F)<<8);
+	p->ChB = (p->Reg[0x1] & 0xFF) | ((p->Reg[0x5] & 0x0F)<<8);
+	p->ChC = (p->Reg[0x2] & 0xFF) | ((p->Reg[0x6] & 0x0F)<<8);
  
-    ChA = ChA + (0x1000 * (ChA==0)); // a Channel Period value of 0
-    ChB = ChB + (0x1000 * (ChB==0)); // indicates a value of 0x1000
-    ChC = ChC + (0x1000 * (ChC==0));
+    p->ChA = p->ChA + (0x1000 * (p->ChA==0)); // a Channel Period value of 0
+    p->ChB = p->ChB + (0x1000 * (p->ChB==0)); // indicates a value of 0x1000
+    p->ChC = p->ChC + (0x1000 * (p->ChC==0));
 
-    NoiseP = (Memory[0x01F9] & 0x1F)<<1;
+    p->NoiseP = (p->Reg[0x9] & 0x1F)<<1;
 
     // a Noise Period of 0 indicates a period of 0x40
-    NoiseP = NoiseP + (0x40 * (NoiseP==0));
+    p->NoiseP = p->NoiseP + (0x40 * (p->NoiseP==0));
 
-    EnvP = ((Memory[0x01F3] & 0xFF) | ((Memory[0x1F7] & 0xFF)<<8))<<1;
+    p->EnvP = ((p->Reg[0x3] & 0xFF) | ((p->Reg[0x7] & 0xFF)<<8))<<1;
 
     // an Envelope Period of 0 indicates a period of 0x20000
-    EnvP = EnvP + (0x20000 * (EnvP==0));
+    p->EnvP = p->EnvP + (0x20000 * (p->EnvP==0));
 
 	// Envelope Flags
-	EnvContinue = (EnvFlags>>3) & 0x01;
-	EnvAttack = (EnvFlags>>2) & 0x01;
-	EnvAlternate = (EnvFlags>>1) & 0x01;
-	EnvHold = EnvFlags & 0x01;
+	p->EnvContinue = (EnvFlags>>3) & 0x01;
+	p->EnvAttack = (EnvFlags>>2) & 0x01;
+	p->EnvAlternate = (EnvFlags>>1) & 0x01;
+	p->EnvHold = EnvFlags & 0x01;
+}
+
+static void resetPSG(struct PSG *p)
+{
+	memset(p, 0, sizeof(*p));
+	p->OutN = 0x10004; // noise output
+	readRegisters(p);
 }
 
 void PSGInit()
 {
 	PSGBufferSize = 7467; // set in psg.h
+	resetPSG(&psg[0]);
+	resetPSG(&psg[1]);
+	ecs = 0;
+}
 
-	OutA = 0; // tone generator outputs
-	OutB = 0;
-	OutC = 0;
-	OutN = 0x10004; // noise output
-	OutE = 0; // envelope output
-	CountA = 0; // tone generator countdowns
-	CountB = 0;
-	CountC = 0;
-	CountN = 0; // noise generator countdown
-	CountE = 0; // envelope countdown
-	readRegisters();
+void PSGEnableECS(void)
+{
+	resetPSG(&psg[1]);
+	ecs = 1;
+}
+
+int PSGHasECS(void)
+{
+	return ecs;
 }
 
 void PSGFrame()
@@ -186,7 +134,8 @@ void PSGFrame()
 	PSGBufferPos = 0;
  #if 0  // Debugging
     {
-        fprintf(stderr, "%04x %04x %04x %02x %02x %02x\n", ChA, ChB, ChC, VolA, VolB, VolC);
+        struct PSG *p = &psg[0];
+        fprintf(stderr, "%04x %04x %04x %02x %02x %02x\n", p->ChA, p->ChB, p->ChC, VolA, VolB, VolC);
     }
  #endif
 }
@@ -198,128 +147,199 @@ int psg_masks[16] = {
     0x3f, 0x3f, 0xff, 0xff,
 };
 
-void PSGNotify(int adr, int val) // PSG Registers Modified 0x01F0-0x1FD (called from writeMem)
+void PSGNotify(int adr, int val) // PSG Registers Modified 0x01F0-0x1FD or ECS 0x00F0-0x00FD (called from writeMem)
 {
-    Memory[adr] &= psg_masks[adr - 0x1f0];
-	readRegisters();
+    struct PSG *p = &psg[adr < 0x100];
+
+    Memory[adr] &= psg_masks[adr & 0xF];
+    p->Reg[adr & 0xF] = Memory[adr];
+	readRegisters(p);
     // Note: updating frequencies doesn't reset counters in real chip
     //       (otherwise sound glitch happens in games)
 
 	// Envelope properties Trigger (write only register)
-	if (adr==0x1FA)  
+	if ((adr & 0xF)==0xA)  
 	{ 
-		CountE = EnvP;
-		StepE = 0;
+		p->CountE = p->EnvP;
+		p->StepE = 0;
 
-		if (EnvAttack) // attack __/|/|/|___
+		if (p->EnvAttack) // attack __/|/|/|___
 		{
-			OutE = 0;
-			StepE = 1;
+			p->OutE = 0;
+			p->StepE = 1;
 		}
 		else
 		{
-			OutE = 15;
-			StepE = -1;
+			p->OutE = 15;
+			p->StepE = -1;
 		}
 	}
 }
 
-void PSGTick(int ticks) // adds 1 sound sample per 4 cpu cycles to the buffer
+static int16_t sample(const struct PSG *p)
 {
-	int16_t sample;
 	int a, b, c;
 
-	Ticks = Ticks + ticks;
+	// http://wiki.intellivision.us/index.php?title=PSG
+	// channel_output = (noise_enable OR noise_generator_output) AND (tone_enable OR tone_generator_output)
+	a = (NoiseA | (p->OutN & 1)) & (ToneA | p->OutA); // Generate Sample for each channel
+	b = (NoiseB | (p->OutN & 1)) & (ToneB | p->OutB);
+	c = (NoiseC | (p->OutN & 1)) & (ToneC | p->OutC);
 
-	while(Ticks >= 4)
-	{
-		Ticks -= 4;
+	// Adjust amplitude (Volume / Envelope)
+	a = a * ( (Volume[VolA] * (EnvA==0)) | (Volume[p->OutE >> Envelope_Shift[EnvA]]) );
+	b = b * ( (Volume[VolB] * (EnvB==0)) | (Volume[p->OutE >> Envelope_Shift[EnvB]]) );
+	c = c * ( (Volume[VolC] * (EnvC==0)) | (Volume[p->OutE >> Envelope_Shift[EnvC]]) );
+
+	return a + b + c;
+}
 
-		CountA--;
-		CountB--;
-		CountC--;
-		CountN--;
-		CountE--;
+// Advance one PSG by one sample (4 cpu cycles)
+static int16_t step(struct PSG *p)
+{
+	int16_t s;
 
-		/* ************** Generate Sample ************** */
+	p->CountA--;
+	p->CountB--;
+	p->CountC--;
+	p->CountN--;
+	p->CountE--;
 
-		OutA = OutA ^ (CountA<=0); // Tone Generators
-		OutB = OutB ^ (CountB<=0); 
-		OutC = OutC ^ (CountC<=0); 
+	/* ************** Generate Sample ************** */
 
-		// http://spatula-city.org/~im14u2c/intv/jzintv-1.0-beta3/doc/programming/psg.txt
-		if(CountE==0) // Envelope Generator 
-		{
-			CountE = EnvP; // reset countdown
-			OutE = OutE + StepE; // step up, step down, or hold
+	p->OutA = p->OutA ^ (p->CountA<=0); // Tone Generators
+	p->OutB = p->OutB ^ (p->CountB<=0); 
+	p->OutC = p->OutC ^ (p->CountC<=0); 
 
-			if(StepE != 0 && (OutE>15 || OutE<0)) // we've reached the top or bottom
-			{
-				if(EnvHold)
-				{ 
-					StepE = 0; // stop changing (hold volume)
-					if(EnvAlternate) // alternate & hold  1011 1111
-					{
-						OutE = 15 * (EnvAttack==0);
-					}
-					else // hold at 0 (1001) or 15 (1101) 
-					{
-						OutE = 15 * (EnvAttack==1);
-					}
+	// http://spatula-city.org/~im14u2c/intv/jzintv-1.0-beta3/doc/programming/psg.txt
+	if(p->CountE==0) // Envelope Generator 
+	{
+		p->CountE = p->EnvP; // reset countdown
+		p->OutE = p->OutE + p->StepE; // step up, step down, or hold
+
+		if(p->StepE != 0 && (p->OutE>15 || p->OutE<0)) // we've reached the top or bottom
+		{
+			if(p->EnvHold)
+			{ 
+				p->StepE = 0; // stop changing (hold volume)
+				if(p->EnvAlternate) // alternate & hold  1011 1111
+				{
+					p->OutE = 15 * (p->EnvAttack==0);
 				}
-				else
+				else // hold at 0 (1001) or 15 (1101) 
+				{
+					p->OutE = 15 * (p->EnvAttack==1);
+				}
+			}
+			else
+			{
+				if(p->EnvAlternate) // triange waves__/\/\/\__ 1010  \/\/\/\___ 1110
 				{
-					if(EnvAlternate) // triange waves__/\/\/\__ 1010  \/\/\/\___ 1110
-					{
-						StepE = StepE * -1;    // Swap step direction
-						OutE = (OutE + StepE) & 0x0F;
-					}
-					else // saw-tooth waves __|\|\|\__ 1000 ___/|/|/|___ 1100
-					{
-						OutE = 15 * (EnvAttack==0);
-					}
+					p->StepE = p->StepE * -1;    // Swap step direction
+					p->OutE = (p->OutE + p->StepE) & 0x0F;
 				}
-				// Anything without continue flag set holds at 0
-				if(EnvContinue==0)
+				else // saw-tooth waves __|\|\|\__ 1000 ___/|/|/|___ 1100
 				{
-					OutE = 0;
-					StepE = 0;
+					p->OutE = 15 * (p->EnvAttack==0);
 				}
 			}
+			// Anything without continue flag set holds at 0
+			if(p->EnvContinue==0)
+			{
+				p->OutE = 0;
+				p->StepE = 0;
+			}
 		}
+	}
+
+	// http://wiki.intellivision.us/index.php?title=PSG
+	// noise = (noise >> 1) ^ ((noise & 1) ? 0x14000 : 0);
+    // The wiki is wrong as MAME says the LFSR noise is
+    // bit 0 + bit 3 so the correct mask is 0x10004
+	if(p->CountN<=0)
+	{
+		p->CountN = p->NoiseP;
+		p->OutN = (p->OutN >> 1) ^ ((p->OutN & 1) * 0x10004); // Noise Generator
+	}
+
+	s = sample(p);
+
+	/* ********************************************* */
 
-		// http://wiki.intellivision.us/index.php?title=PSG
-		// noise = (noise >> 1) ^ ((noise & 1) ? 0x14000 : 0);
-        // The wiki is wrong as MAME says the LFSR noise is
-        // bit 0 + bit 3 so the correct mask is 0x10004
-		if(CountN<=0)
+	p->CountA += p->ChA * (p->CountA<=0); // reset countdowns when they reach 0 
+	p->CountB += p->ChB * (p->CountB<=0);
+	p->CountC += p->ChC * (p->CountC<=0);
+
+	return s;
+}
+
+// Generate n samples from one PSG into out, or mix them into what the
+// console PSG already put there.  Between counter events the output
+// can't change, so those stretches are filled without stepping.
+static void run(struct PSG *p, int16_t *out, int n, int mix)
+{
+	int k;
+	int16_t s;
+
+	while(n > 0)
+	{
+		// samples before the next tone, noise or envelope event
+		k = p->CountA;
+		if(p->CountB < k) { k = p->CountB; }
+		if(p->CountC < k) { k = p->CountC; }
+		if(p->CountN < k) { k = p->CountN; }
+		if(p->CountE > 0 && p->CountE < k) { k = p->CountE; }
+		k--;
+
+		if(k > 0)
+		{
+			if(k > n) { k = n; }
+			p->CountA -= k;
+			p->CountB -= k;
+			p->CountC -= k;
+			p->CountN -= k;
+			p->CountE -= k;
+			s = sample(p);
+		}
+		else
 		{
-			CountN = NoiseP;
-			OutN = (OutN >> 1) ^ ((OutN & 1) * 0x10004); // Noise Generator
+			k = 1;
+			s = step(p);
 		}
+		n -= k;
 
-		// http://wiki.intellivision.us/index.php?title=PSG
-		// channel_output = (noise_enable OR noise_generator_output) AND (tone_enable OR tone_generator_output)
-		a = (NoiseA | (OutN & 1)) & (ToneA | OutA); // Generate Sample for each channel
-		b = (NoiseB | (OutN & 1)) & (ToneB | OutB);
-		c = (NoiseC | (OutN & 1)) & (ToneC | OutC);
+		if(mix)
+		{
+			for(; k > 0; k--, out++) { *out = (*out + s) >> 1; }
+		}
+		else
+		{
+			for(; k > 0; k--) { *out++ = s; }
+		}
+	}
+}
 
-		// Adjust amplitude (Volume / Envelope)
-		a = a * ( (Volume[VolA] * (EnvA==0)) | (Volume[OutE >> Envelope_Shift[EnvA]]) );
-		b = b * ( (Volume[VolB] * (EnvB==0)) | (Volume[OutE >> Envelope_Shift[EnvB]]) );
-		c = c * ( (Volume[VolC] * (EnvC==0)) | (Volume[OutE >> Envelope_Shift[EnvC]]) );
+void PSGTick(int ticks) // adds 1 sound sample per 4 cpu cycles to the buffer
+{
+	int n, steps;
 
-		sample = a + b + c;
+	Ticks = Ticks + ticks;
+	steps = Ticks >> 2;
+	Ticks &= 3;
 
-		/* ********************************************* */
+	while(steps > 0)
+	{
+		n = PSGBufferSize - PSGBufferPos; // samples until the buffer wraps
+		if(n > steps) { n = steps; }
 
-		CountA += ChA * (CountA<=0); // reset countdowns when they reach 0 
-		CountB += ChB * (CountB<=0);
-		CountC += ChC * (CountC<=0);
+		run(&psg[0], &PSGBuffer[PSGBufferPos], n, 0);
+		if(ecs)
+		{
+			run(&psg[1], &PSGBuffer[PSGBufferPos], n, 1);
+		}
 
-		PSGBuffer[PSGBufferPos] = sample; // write sample to buffer
-		
-		PSGBufferPos++;
-		PSGBufferPos = PSGBufferPos * (PSGBufferPos < 7467); // wrap to beginning
+		PSGBufferPos += n;
+		PSGBufferPos = PSGBufferPos * (PSGBufferPos < PSGBufferSize); // wrap to beginning
+		steps -= n;
 	}
 }
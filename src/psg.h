@@ -24,13 +24,11 @@ extern int16_t PSGBuffer[7467]; // 14934 cpu cycles/frame ; 3733.5 psg cycles/fr
 extern int PSGBufferPos; // points to next location in output buffer
 extern int PSGBufferSize;
 
-struct PSGserialized {
-    int PSGBufferSize;
-    int16_t PSGBuffer[7467];
-    int PSGBufferPos;
-    
-    int Ticks; // CPU cycles not yet processed
-    
+// One AY-3-8914.  The console has one at $01F0; the ECS adds a second
+// at $00F0.  Both run from the same kernel and are mixed into PSGBuffer.
+struct PSG {
+    int Reg[14]; // register file, as masked by the chip
+
     int CountA; // countdowns for tone generators
     int CountB; // used to modulate square-wave
     int CountC; // according to Channel Period
@@ -58,10 +56,24 @@ struct PSGserialized {
     int EnvHold;
 };
 
+// PSGBuffer is not saved: states are taken between frames, when
+// PSGFrame() has just emptied it.
+struct PSGserialized {
+    int PSGBufferSize;
+    int PSGBufferPos;
+    
+    int Ticks; // CPU cycles not yet processed
+    int ECS;   // second PSG present
+
+    struct PSG psg[2];
+};
+
 void PSGSerialize(struct PSGserialized *);
 void PSGUnserialize(const struct PSGserialized *);
 
 void PSGInit(void); 
+void PSGEnableECS(void); // add the ECS PSG at $00F0
+int PSGHasECS(void);
 void PSGFrame(void); // Notify New Frame
 void PSGTick(int ticks); // ticks PSG some number of cpu cycles 
 void PSGNotify(int adr, int val); // updates PSG on register change
@@ -0,0 +1,255 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "state.h"
+#include "rewind.h"
+#include "log.h"
+
+// Deltas are mostly zero.  They are packed as tokens of
+//   uint16 zero run, uint16 literal count, literal bytes
+// Zero runs shorter than MIN_ZERO_RUN are kept as literals, so the
+// packed size never grows past the input size plus one token.
+#define MIN_ZERO_RUN 8
+#define MAX_RUN      0xFFFF
+
+// Ring records are [uint32 length][payload][uint32 length]; the trailing
+// length lets the newest record be found from the head.
+#define RECORD_OVERHEAD 8
+
+static uint8_t *ring;       // delta records, oldest at ringTail
+static size_t ringSize;
+static size_t ringHead;     // next free byte
+static size_t ringTail;     // oldest record
+static size_t ringUsed;
+static int records;
+
+static uint8_t *current;    // newest snapshot
+static uint8_t *snapshot;   // scratch for the incoming snapshot
+static uint8_t *packed;     // scratch for a packed delta
+static size_t stateSize;
+static int haveCurrent;
+
+void RewindFree(void)
+{
+	free(ring);
+	free(current);
+	free(snapshot);
+	free(packed);
+	ring = current = snapshot = packed = NULL;
+	ringSize = ringHead = ringTail = ringUsed = 0;
+	records = 0;
+	haveCurrent = 0;
+}
+
+// (re)size the snapshot buffers for the current memory map
+static int allocSnapshots(void)
+{
+	free(current);
+	free(snapshot);
+	free(packed);
+	stateSize = StateMaxSize();
+	current = (uint8_t *) malloc(stateSize);
+	snapshot = (uint8_t *) malloc(stateSize);
+	packed = (uint8_t *) malloc(stateSize + stateSize / 1024 + 16);
+	haveCurrent = 0;
+	return current != NULL && snapshot != NULL && packed != NULL;
+}
+
+void RewindInit(size_t budget)
+{
+	RewindFree();
+	if(budget == 0)
+		return;
+
+	ring = (uint8_t *) malloc(budget);
+	if(ring == NULL || !allocSnapshots())
+	{
+		LogError("[FREEINTV] Unable to allocate %u byte rewind buffer\n", (unsigned) budget);
+		RewindFree();
+		return;
+	}
+	ringSize = budget;
+	LogInfo("[FREEINTV] Rewind buffer: %u KB\n", (unsigned) (budget / 1024));
+}
+
+int RewindEnabled(void)
+{
+	return ring != NULL;
+}
+
+static void ringWrite(size_t pos, const void *data, size_t len)
+{
+	size_t first = ringSize - pos;
+	if(first > len)
+		first = len;
+	memcpy(ring + pos, data, first);
+	memcpy(ring, (const uint8_t *) data + first, len - first);
+}
+
+static void ringRead(size_t pos, void *data, size_t len)
+{
+	size_t first = ringSize - pos;
+	if(first > len)
+		first = len;
+	memcpy(data, ring + pos, first);
+	memcpy((uint8_t *) data + first, ring, len - first);
+}
+
+// XOR a and b and pack the result into out, returns packed size
+static size_t packDelta(const uint8_t *a, const uint8_t *b, size_t len, uint8_t *out)
+{
+	size_t i = 0, o = 0, lit, zero, j;
+	uint16_t hdr[2];
+
+	while(i < len)
+	{
+		zero = 0;
+		while(i + zero < len && zero < MAX_RUN && a[i + zero] == b[i + zero])
+			zero++;
+		i += zero;
+
+		// literals run until the next long stretch of equal bytes
+		lit = 0;
+		while(i + lit < len && lit < MAX_RUN)
+		{
+			for(j = 0; j < MIN_ZERO_RUN && i + lit + j < len && a[i + lit + j] == b[i + lit + j]; j++) { }
+			if(j == MIN_ZERO_RUN || i + lit + j == len)
+				break;
+			lit += j + 1;
+		}
+		if(lit > MAX_RUN)
+			lit = MAX_RUN;
+
+		hdr[0] = (uint16_t) zero;
+		hdr[1] = (uint16_t) lit;
+		memcpy(out + o, hdr, sizeof(hdr));
+		o += sizeof(hdr);
+		for(j = 0; j < lit; j++)
+			out[o + j] = a[i + j] ^ b[i + j];
+		o += lit;
+		i += lit;
+	}
+	return o;
+}
+
+// XOR a packed delta into data
+static void applyDelta(uint8_t *data, size_t len, const uint8_t *in, size_t inLen)
+{
+	size_t i = 0, o = 0, j;
+	uint16_t hdr[2];
+
+	while(o + sizeof(hdr) <= inLen)
+	{
+		memcpy(hdr, in + o, sizeof(hdr));
+		o += sizeof(hdr);
+		i += hdr[0];
+		for(j = 0; j < hdr[1] && i < len && o < inLen; j++)
+			data[i++] ^= in[o++];
+	}
+}
+
+static void dropOldest(void)
+{
+	uint32_t len;
+	ringRead(ringTail, &len, 4);
+	ringTail = (ringTail + len + RECORD_OVERHEAD) % ringSize;
+	ringUsed -= len + RECORD_OVERHEAD;
+	records--;
+}
+
+void RewindPush(void)
+{
+	size_t used;
+	uint32_t len;
+
+	if(ring == NULL)
+		return;
+
+	// the map grows after RewindInit when a cart adds JLP flash, ECS
+	// or .cfg RAM; deltas of the old size can't be applied, start over
+	if(StateMaxSize() != stateSize)
+	{
+		ringHead = ringTail = ringUsed = 0;
+		records = 0;
+		if(!allocSnapshots())
+		{
+			LogError("[FREEINTV] Unable to allocate rewind snapshots\n");
+			RewindFree();
+			return;
+		}
+	}
+
+	used = StateSave(snapshot, stateSize, STATE_ALL);
+	if(used == 0)
+		return;
+	memset(snapshot + used, 0, stateSize - used);
+
+	if(haveCurrent)
+	{
+		len = (uint32_t) packDelta(current, snapshot, stateSize, packed);
+		if(len + RECORD_OVERHEAD > ringSize)
+		{
+			// cannot hold even one step, start the history over
+			ringHead = ringTail = ringUsed = 0;
+			records = 0;
+		}
+		else
+		{
+			while(ringUsed + len + RECORD_OVERHEAD > ringSize)
+				dropOldest();
+			ringWrite(ringHead, &len, 4);
+			ringWrite((ringHead + 4) % ringSize, packed, len);
+			ringWrite((ringHead + 4 + len) % ringSize, &len, 4);
+			ringHead = (ringHead + len + RECORD_OVERHEAD) % ringSize;
+			ringUsed += len + RECORD_OVERHEAD;
+			records++;
+		}
+	}
+
+	memcpy(current, snapshot, stateSize);
+	haveCurrent = 1;
+}
+
+int RewindPop(void)
+{
+	uint32_t len;
+	size_t start;
+
+	if(ring == NULL || !haveCurrent)
+		return 0;
+
+	if(!StateLoad(current, stateSize, STATE_ALL))
+		return 0;
+
+	// the oldest snapshot stays, holding rewind freezes on it
+	if(records == 0)
+		return 1;
+
+	// step current back to the snapshot before it
+	ringRead((ringHead + ringSize - 4) % ringSize, &len, 4);
+	start = (ringHead + ringSize - len - 4) % ringSize;
+	ringRead(start, packed, len);
+	applyDelta(current, stateSize, packed, len);
+	ringHead = (start + ringSize - 4) % ringSize;
+	ringUsed -= len + RECORD_OVERHEAD;
+	records--;
+	return 1;
+}
@@ -0,0 +1,36 @@
+#ifndef REWIND_H
+#define REWIND_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stddef.h>
+
+// In-core rewind: a ring of savestates kept as compressed XOR deltas
+// against the following snapshot, so stepping back one frame costs one
+// delta decode and one StateLoad no matter how long the history is.
+
+void RewindInit(size_t budget); // budget in bytes, 0 disables rewind
+
+void RewindFree(void);
+
+int RewindEnabled(void);
+
+void RewindPush(void); // snapshot the current state, call before each frame
+
+int RewindPop(void); // restore the newest snapshot and drop it, 0 if none
+
+#endif
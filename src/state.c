@@ -0,0 +1,394 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "intv.h"
+#include "memory.h"
+#include "cp1610.h"
+#include "stic.h"
+#include "psg.h"
+#include "ivoice.h"
+#include "jlp.h"
+#include "state.h"
+#include "log.h"
+
+#define STATE_TAG(a,b,c,d) ((uint32_t)(a) | ((uint32_t)(b)<<8) | ((uint32_t)(c)<<16) | ((uint32_t)(d)<<24))
+
+#define STATE_MAGIC     STATE_TAG('F','I','N','T')
+#define STATE_VERSION   1
+
+#define TAG_CPU  STATE_TAG('C','P','U',' ')
+#define TAG_STIC STATE_TAG('S','T','I','C')
+#define TAG_PSG  STATE_TAG('P','S','G',' ')
+#define TAG_IVOC STATE_TAG('I','V','O','C')
+#define TAG_MEM  STATE_TAG('M','E','M',' ')
+#define TAG_INTV STATE_TAG('I','N','T','V')
+#define TAG_BANK STATE_TAG('B','A','N','K')
+#define TAG_JLP  STATE_TAG('J','L','P',' ')
+#define TAG_END  STATE_TAG('E','N','D',' ')
+
+#define CHUNK_HEADER 12
+
+// chunks a state must contain
+#define HAVE_CPU   0x01
+#define HAVE_STIC  0x02
+#define HAVE_PSG   0x04
+#define HAVE_IVOC  0x08
+#define HAVE_MEM   0x10
+#define HAVE_INTV  0x20
+#define HAVE_ALL   0x3F
+
+// Memory that writeMem can change, stored as 16-bit words: the RAM pages
+// of the memory map and GRAM, which its aliases write to.  Everything
+// else is ROM reloaded with the cart.
+static int savedPage(int page)
+{
+	return MemoryMap[page]==MEM_RAM || MemoryMap[page]==MEM_RAM8 ||
+		MemoryMap[page]==MEM_JLP || page==0x38 || page==0x39;
+}
+
+// selected page of each 4K segment, optional so older states still load
+struct BANKserialized {
+	uint8_t page[16];
+};
+
+static void bankSerialize(struct BANKserialized *bank)
+{
+	int i;
+	for(i=0; i<16; i++)
+		bank->page[i] = MemoryGetPage(i);
+}
+
+struct INTVserialized {
+	int SR1;
+	int intv_halt;
+	unsigned int intv_frames;
+};
+
+// scratch space for chunk payloads
+static struct ivoiceSerialized ivoiceState;
+
+static size_t memWords(void)
+{
+	size_t n = 0;
+	int page;
+	for(page=0; page<0x100; page++)
+		n += savedPage(page) ? 0x100 : 0;
+	return n;
+}
+
+static uint8_t *putHeader(uint8_t *p, uint32_t tag, uint32_t version, uint32_t length)
+{
+	memcpy(p, &tag, 4);
+	memcpy(p + 4, &version, 4);
+	memcpy(p + 8, &length, 4);
+	return p + CHUNK_HEADER;
+}
+
+static uint8_t *putChunk(uint8_t *p, uint32_t tag, uint32_t version, const void *payload, uint32_t length)
+{
+	p = putHeader(p, tag, version, length);
+	memcpy(p, payload, length);
+	return p + length;
+}
+
+size_t StateMaxSize(void)
+{
+	return 8 + CHUNK_HEADER * 9 +
+		sizeof(struct CP1610serialized) +
+		sizeof(struct STICserialized) +
+		sizeof(struct PSGserialized) +
+		sizeof(struct ivoiceSerialized) +
+		memWords() * sizeof(uint16_t) +
+		sizeof(struct BANKserialized) +
+		sizeof(struct JLPserialized) + JLPFlashWords() * sizeof(uint16_t) +
+		sizeof(struct INTVserialized);
+}
+
+size_t StateSave(void *data, size_t size, int flags)
+{
+	struct CP1610serialized cpu;
+	struct STICserialized stic;
+	struct PSGserialized psg;
+	struct BANKserialized bank;
+	struct JLPserialized jlp;
+	struct INTVserialized intv;
+	uint8_t *p = (uint8_t *) data;
+	uint16_t *w;
+	uint32_t magic = STATE_MAGIC;
+	uint32_t version = STATE_VERSION;
+	int adr;
+
+	if(size < StateMaxSize())
+		return 0;
+
+	memcpy(p, &magic, 4);
+	memcpy(p + 4, &version, 4);
+	p += 8;
+
+	CP1610Serialize(&cpu);
+	p = putChunk(p, TAG_CPU, 1, &cpu, sizeof(cpu));
+
+	STICSerialize(&stic);
+	p = putChunk(p, TAG_STIC, 1, &stic, sizeof(stic));
+
+	PSGSerialize(&psg);
+	p = putChunk(p, TAG_PSG, 2, &psg, sizeof(psg));
+
+	p = putChunk(p, TAG_IVOC, 1, &ivoiceState, ivoiceSerialize(&ivoiceState));
+
+	if(!(flags & STATE_NO_MEMORY))
+	{
+		p = putHeader(p, TAG_MEM, 1, memWords() * sizeof(uint16_t));
+		w = (uint16_t *) p;
+		for(adr=0; adr<0x10000; adr++)
+		{
+			if(savedPage(adr>>8))
+				*w++ = Memory[adr];
+		}
+		p = (uint8_t *) w;
+	}
+
+	bankSerialize(&bank);
+	p = putChunk(p, TAG_BANK, 1, &bank, sizeof(bank));
+
+	// flash is part of the state so rewind and run-ahead undo saves too
+	JLPSerialize(&jlp);
+	p = putHeader(p, TAG_JLP, 2, sizeof(jlp) + JLPFlashWords() * sizeof(uint16_t));
+	memcpy(p, &jlp, sizeof(jlp));
+	if(JLPFlashWords())
+		memcpy(p + sizeof(jlp), JLPFlash(), JLPFlashWords() * sizeof(uint16_t));
+	p += sizeof(jlp) + JLPFlashWords() * sizeof(uint16_t);
+
+	intv.SR1 = SR1;
+	intv.intv_halt = intv_halt;
+	intv.intv_frames = intv_frames;
+	p = putChunk(p, TAG_INTV, 1, &intv, sizeof(intv));
+
+	p = putHeader(p, TAG_END, 1, 0);
+
+	return p - (uint8_t *) data;
+}
+
+// Walks the chunk list.  With apply == 0 only checks that every chunk
+// is well formed, so a bad state is rejected before anything changes.
+static int loadChunks(const uint8_t *p, const uint8_t *end, int apply, int required)
+{
+	const struct ivoiceSerialized *iv;
+	struct CP1610serialized cpu;
+	struct STICserialized stic;
+	struct PSGserialized psg;
+	struct BANKserialized bank;
+	struct JLPserialized jlp;
+	struct INTVserialized intv;
+	uint32_t tag, version, length;
+	const uint16_t *w;
+	int found = 0;
+	int adr;
+
+	while(p + CHUNK_HEADER <= end)
+	{
+		memcpy(&tag, p, 4);
+		memcpy(&version, p + 4, 4);
+		memcpy(&length, p + 8, 4);
+		p += CHUNK_HEADER;
+		if(length > (size_t)(end - p))
+			return 0;
+
+		if(tag == TAG_END)
+			return (found & required) == required;
+
+		switch(tag)
+		{
+			case TAG_CPU:
+				if(version != 1 || length != sizeof(struct CP1610serialized))
+					return 0;
+				if(apply)
+				{
+					memcpy(&cpu, p, sizeof(cpu));
+					CP1610Unserialize(&cpu);
+				}
+				found |= HAVE_CPU;
+				break;
+			case TAG_STIC:
+				if(version != 1 || length != sizeof(struct STICserialized))
+					return 0;
+				if(apply)
+				{
+					memcpy(&stic, p, sizeof(stic));
+					STICUnserialize(&stic);
+				}
+				found |= HAVE_STIC;
+				break;
+			case TAG_PSG:
+				if(version != 2 || length != sizeof(struct PSGserialized))
+					return 0;
+				if(apply)
+				{
+					memcpy(&psg, p, sizeof(psg));
+					PSGUnserialize(&psg);
+				}
+				found |= HAVE_PSG;
+				break;
+			case TAG_IVOC:
+				if(version != 1 || length < offsetof(struct ivoiceSerialized, samples) ||
+					length > sizeof(struct ivoiceSerialized))
+					return 0;
+				memcpy(&ivoiceState, p, length);
+				iv = &ivoiceState;
+				if(iv->scratchLen < 0 || iv->scratchLen > SCBUF_SIZE ||
+					iv->main.sc_head - iv->main.sc_tail != (uint32_t) iv->scratchLen ||
+					iv->main.cur_len < 0 || iv->main.cur_len > AUDIO_FREQUENCY / 60 * 2 ||
+					length != offsetof(struct ivoiceSerialized, samples) +
+						(iv->scratchLen + iv->main.cur_len) * sizeof(int16_t))
+					return 0;
+				if(apply)
+					ivoiceUnserialize(iv);
+				found |= HAVE_IVOC;
+				break;
+			case TAG_MEM:
+				if(version != 1 || length != memWords() * sizeof(uint16_t))
+					return 0;
+				if(apply)
+				{
+					MemoryHashInvalidate();
+					w = (const uint16_t *) p;
+					for(adr=0; adr<0x10000; adr++)
+					{
+						if(savedPage(adr>>8))
+							Memory[adr] = *w++;
+					}
+				}
+				found |= HAVE_MEM;
+				break;
+			case TAG_BANK:
+				if(version != 1 || length != sizeof(struct BANKserialized))
+					return 0;
+				if(apply)
+				{
+					memcpy(&bank, p, sizeof(bank));
+					for(adr=0; adr<16; adr++)
+						MemorySelectPage(adr, bank.page[adr]);
+				}
+				break;
+			case TAG_JLP:
+				if(version != 2 || length != sizeof(struct JLPserialized) + JLPFlashWords() * sizeof(uint16_t))
+					return 0;
+				if(apply)
+				{
+					memcpy(&jlp, p, sizeof(jlp));
+					JLPUnserialize(&jlp);
+					if(JLPFlashWords())
+						memcpy(JLPFlash(), p + sizeof(jlp), JLPFlashWords() * sizeof(uint16_t));
+				}
+				break;
+			case TAG_INTV:
+				if(version != 1 || length != sizeof(struct INTVserialized))
+					return 0;
+				if(apply)
+				{
+					memcpy(&intv, p, sizeof(intv));
+					SR1 = intv.SR1;
+					intv_halt = intv.intv_halt;
+					intv_frames = intv.intv_frames;
+				}
+				found |= HAVE_INTV;
+				break;
+			default: // unknown chunk from a newer core, skip
+				break;
+		}
+		p += length;
+	}
+	return 0;
+}
+
+// FNV-1a over the bytes of a serialized struct
+static uint64_t hashBytes(uint64_t h, const void *data, size_t len)
+{
+	const uint8_t *p = (const uint8_t *) data;
+	size_t i;
+	for(i=0; i<len; i++)
+	{
+		h ^= p[i];
+		h *= 0x100000001B3ULL;
+	}
+	return h;
+}
+
+uint64_t StateHash(void)
+{
+	struct CP1610serialized cpu;
+	struct STICserialized stic;
+	struct PSGserialized psg;
+	struct BANKserialized bank;
+	struct JLPserialized jlp;
+	struct INTVserialized intv;
+	uint64_t h = 0xCBF29CE484222325ULL;
+	size_t live;
+
+	CP1610Serialize(&cpu);
+	h = hashBytes(h, &cpu, sizeof(cpu));
+	STICSerialize(&stic);
+	h = hashBytes(h, &stic, sizeof(stic));
+	PSGSerialize(&psg);
+	h = hashBytes(h, &psg, sizeof(psg));
+
+	// skip the buffer pointers, they differ between instances
+	live = ivoiceSerialize(&ivoiceState);
+	h = hashBytes(h, &ivoiceState, offsetof(struct ivoiceSerialized, main.cur_buf));
+	h = hashBytes(h, &ivoiceState.ivoiceBufferSize, live - offsetof(struct ivoiceSerialized, ivoiceBufferSize));
+
+	intv.SR1 = SR1;
+	intv.intv_halt = intv_halt;
+	intv.intv_frames = intv_frames;
+	h = hashBytes(h, &intv, sizeof(intv));
+
+	bankSerialize(&bank);
+	h = hashBytes(h, &bank, sizeof(bank));
+
+	JLPSerialize(&jlp);
+	h = hashBytes(h, &jlp, sizeof(jlp));
+	h = hashBytes(h, JLPFlash(), JLPFlashWords() * sizeof(uint16_t));
+
+	return h ^ MemoryHash();
+}
+
+int StateLoad(const void *data, size_t size, int flags)
+{
+	const uint8_t *p = (const uint8_t *) data;
+	uint32_t magic, version;
+	int required = (flags & STATE_NO_MEMORY) ? HAVE_ALL & ~HAVE_MEM : HAVE_ALL;
+
+	if(size < 8)
+		return 0;
+	memcpy(&magic, p, 4);
+	memcpy(&version, p + 4, 4);
+	if(magic != STATE_MAGIC || version != STATE_VERSION)
+	{
+		LogError("[FREEINTV] Unsupported savestate format\n");
+		return 0;
+	}
+	if(!loadChunks(p + 8, p + size, 0, required))
+	{
+		LogError("[FREEINTV] Savestate is corrupt or incomplete\n");
+		return 0;
+	}
+	return loadChunks(p + 8, p + size, 1, required);
+}
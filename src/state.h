@@ -0,0 +1,45 @@
+#ifndef STATE_H
+#define STATE_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+// Savestate layout (host byte order):
+//   uint32 magic, uint32 format version
+//   chunks: uint32 tag, uint32 version, uint32 length, payload[length]
+//   terminated by an "END " chunk
+// Loaders skip chunks with unknown tags.  The framebuffer and audio
+// buffers are regenerated by the next frame and are not saved.
+
+// flags for StateSave/StateLoad
+#define STATE_ALL        0
+#define STATE_NO_MEMORY  1  // leave out MEM, the caller restores memory itself
+
+size_t StateMaxSize(void); // upper bound for StateSave
+
+size_t StateSave(void *data, size_t size, int flags); // returns bytes written, 0 on failure
+
+int StateLoad(const void *data, size_t size, int flags); // returns 1 on success
+
+// 64-bit hash of the machine state (CPU, memory, STIC, PSG, Intellivoice).
+// Two instances in the same state give the same value, so netplay desync
+// checks and golden-run comparisons need one integer compare per frame.
+uint64_t StateHash(void);
+
+#endif
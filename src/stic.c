@@ -137,7 +137,6 @@ void STICSerialize(struct STICserialized *all)
     all->CSP = CSP;
     memcpy(all->fgcard, fgcard, sizeof(fgcard));
     memcpy(all->bgcard, bgcard, sizeof(bgcard));
-    memcpy(all->frame, frame, sizeof(frame));
 }
 
 void STICUnserialize(const struct STICserialized *all)
@@ -156,7 +155,6 @@ void STICUnserialize(const struct STICserialized *all)
     CSP = all->CSP;
     memcpy(fgcard, all->fgcard, sizeof(fgcard));
     memcpy(bgcard, all->bgcard, sizeof(bgcard));
-    memcpy(frame, all->frame, sizeof(frame));
 }
 
 void STICReset(void)
@@ -530,6 +528,22 @@ void drawSprites(int scanline) // MOBs
 	}
 }
 
+int STICCanCollide(void)
+{
+	int i, Rx, posX;
+
+	if (!stic_vid_enable)
+		return 0; // a blanked frame only draws the border color
+	for (i = 0; i < 8; i++)
+	{
+		Rx = Memory[0x00+i];
+		posX = Rx & 0xFF;
+		if (((Rx>>8)&1) && posX != 0 && posX <= 167 && (Memory[0x08+i] & 0x7F) <= 104)
+			return 1;
+	}
+	return 0;
+}
+
 void STICDrawFrame(int enabled)
 {
 	int row, offset;
@@ -18,6 +18,19 @@
 	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+// STIC phase lengths in CPU cycles (NTSC).  Phase 2 and phase 14 trade
+// cycles according to the vertical/horizontal delay registers, so the sum
+// below is the length of every frame regardless of scrolling.
+#define STIC_VBLANK1_CYCLES  2900    // phase 0: start of VBLANK, SR1 asserted
+#define STIC_VBLANK2_CYCLES  896     // phase 1: rest of VBLANK
+#define STIC_TOP_CYCLES      120     // phase 2: top border (+114*delayV+delayH)
+#define STIC_ROW_CYCLES      912     // phases 3-14: one card row each
+#define STIC_ROWS            12
+#define STIC_BOTTOM_CYCLES   (57 + 17) // phase 15: bottom border
+#define STIC_FRAME_CYCLES    (STIC_VBLANK1_CYCLES + STIC_VBLANK2_CYCLES + \
+                              STIC_TOP_CYCLES + STIC_ROWS * STIC_ROW_CYCLES + \
+                              STIC_BOTTOM_CYCLES) // 14934
+
 extern unsigned int STICMode; // 0-foreground/background, 1-color stack/color squares 
 
 extern int stic_phase;
@@ -52,8 +65,6 @@ struct STICserialized {
     unsigned int CSP;
     unsigned int fgcard[20];
     unsigned int bgcard[20];
-
-    unsigned int frame[352*224];
 };
 
 void STICSerialize(struct STICserialized *);
@@ -62,4 +73,9 @@ void STICUnserialize(const struct STICserialized *);
 void STICDrawFrame(int);
 void STICReset(void);
 
+// 1 if drawing the next frame could set collision bits ($18-$1F): some
+// MOB is interactive and on screen.  Otherwise a frame nobody will see
+// can be skipped without changing the machine.
+int STICCanCollide(void);
+
 #endif
@@ -0,0 +1,411 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intv.h"
+#include "cp1610.h"
+#include "memory.h"
+#include "trace.h"
+#include "log.h"
+#include "file/file_path.h"
+
+int TraceEnabled = 0;
+int TraceDiverged = 0;
+
+extern unsigned int R[8];
+extern int Flag_DoubleByteData;
+extern int Flag_InteruptEnable;
+extern int Flag_Carry;
+extern int Flag_Sign;
+extern int Flag_Zero;
+extern int Flag_Overflow;
+
+static struct traceRecord *ring = NULL;
+static uint32_t head = 0;   // next record to write
+static uint32_t count = 0;  // records held, up to TRACE_RECORDS
+static uint64_t cycles = 0; // CPU cycles since TraceStart
+static struct traceRecord *last = NULL;
+
+static struct traceRecord *ref = NULL; // reference trace being verified
+static uint32_t refCount = 0;
+static uint32_t refPos = 0;
+static int refSynced = 0;
+static uint32_t refBase = 0; // live cycle count at ref[0]
+
+int TraceStart(void)
+{
+	if (ring == NULL)
+		ring = (struct traceRecord *) malloc(TRACE_RECORDS * sizeof(struct traceRecord));
+	if (ring == NULL)
+		return 0;
+	head = count = 0;
+	cycles = 0;
+	last = NULL;
+	TraceDiverged = 0;
+	TraceEnabled = 1;
+	return 1;
+}
+
+static void freeReference(void)
+{
+	free(ref);
+	ref = NULL;
+	refCount = refPos = 0;
+	refSynced = 0;
+}
+
+int TraceVerifyStart(const char *refPath)
+{
+	char line[256], flags[16];
+	unsigned int r[8], cycle;
+	uint32_t alloc = 0;
+	FILE *fp;
+	int i;
+
+	freeReference();
+	if ((fp = fopen(refPath, "r")) == NULL)
+		return 0;
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		struct traceRecord *t;
+		char *end, *field;
+		int used = 0;
+
+		if (sscanf(line, " %x %x %x %x %x %x %x %x %15s %n", &r[0], &r[1], &r[2], &r[3],
+			&r[4], &r[5], &r[6], &r[7], flags, &used) != 9 || used == 0 || strlen(flags) != 8)
+			continue;
+		// the cycle count is the last field; the disassembly before it
+		// has a varying number of words
+		end = line + strlen(line);
+		while (end > line + used && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+			end--;
+		*end = '\0';
+		field = end;
+		while (field > line + used && field[-1] != ' ' && field[-1] != '\t')
+			field--;
+		if (field == end || strspn(field, "0123456789") != (size_t) (end - field))
+			continue;
+		cycle = (unsigned int) strtoul(field, NULL, 10);
+		if (refCount == alloc)
+		{
+			struct traceRecord *grown;
+			alloc = alloc ? alloc * 2 : 65536;
+			grown = (struct traceRecord *) realloc(ref, alloc * sizeof(struct traceRecord));
+			if (grown == NULL)
+				break;
+			ref = grown;
+		}
+		t = &ref[refCount++];
+		for (i = 0; i < 8; i++)
+			t->R[i] = (uint16_t) r[i];
+		t->opcode = 0xFFFF; // only the disassembly, which isn't compared
+		t->operand[0] = t->operand[1] = 0;
+		t->flags = (flags[0] == 'S' ? TRACE_S : 0) | (flags[1] == 'Z' ? TRACE_Z : 0) |
+			(flags[2] == 'O' ? TRACE_O : 0) | (flags[3] == 'C' ? TRACE_C : 0) |
+			(flags[4] == 'I' ? TRACE_I : 0) | (flags[5] == 'D' ? TRACE_D : 0) |
+			(flags[7] == 'q' ? TRACE_Q : 0);
+		t->ticks = 0;
+		t->cycle = cycle;
+	}
+	fclose(fp);
+
+	if (refCount == 0 || !TraceStart())
+	{
+		freeReference();
+		return 0;
+	}
+	LogInfo("[FREEINTV] Trace: verifying against %u instructions from %s\n", (unsigned int) refCount, refPath);
+	return 1;
+}
+
+void TraceStop(void)
+{
+	if (ref != NULL)
+	{
+		if (!refSynced)
+			LogInfo("[FREEINTV] Trace: never reached the first reference instruction\n");
+		else
+			LogInfo("[FREEINTV] Trace: %u of %u reference instructions matched\n", (unsigned int) refPos, (unsigned int) refCount);
+		freeReference();
+	}
+	TraceEnabled = 0;
+	last = NULL;
+	free(ring);
+	ring = NULL;
+}
+
+static int sameState(const struct traceRecord *a, const struct traceRecord *b)
+{
+	return memcmp(a->R, b->R, sizeof(a->R)) == 0 && a->flags == b->flags;
+}
+
+static void describe(const char *what, const struct traceRecord *t, uint32_t cycle)
+{
+	LogError("[FREEINTV]   %s %04X %04X %04X %04X %04X %04X %04X %04X %c%c%c%c%c%c%c +%u\n", what,
+		t->R[0], t->R[1], t->R[2], t->R[3], t->R[4], t->R[5], t->R[6], t->R[7],
+		t->flags & TRACE_S ? 'S' : '-',
+		t->flags & TRACE_Z ? 'Z' : '-',
+		t->flags & TRACE_O ? 'O' : '-',
+		t->flags & TRACE_C ? 'C' : '-',
+		t->flags & TRACE_I ? 'I' : '-',
+		t->flags & TRACE_D ? 'D' : '-',
+		t->flags & TRACE_Q ? 'q' : '-',
+		(unsigned int) cycle);
+}
+
+static void verify(const struct traceRecord *t)
+{
+	const struct traceRecord *e;
+
+	if (!refSynced)
+	{
+		if (!sameState(t, &ref[0]))
+			return;
+		refSynced = 1;
+		refBase = t->cycle;
+	}
+
+	e = &ref[refPos];
+	if (!sameState(t, e) || t->cycle - refBase != e->cycle - ref[0].cycle)
+	{
+		if (refPos < TRACE_SYNC && refPos < refCount - 1)
+		{
+			// lined up with the wrong pass through a loop, keep looking
+			refSynced = 0;
+			refPos = 0;
+			if (sameState(t, &ref[0]))
+			{
+				refSynced = 1;
+				refBase = t->cycle;
+				refPos = 1;
+			}
+			return;
+		}
+		LogError("[FREEINTV] Trace: diverged from the reference at instruction %u\n", (unsigned int) refPos);
+		describe("expected", e, e->cycle - ref[0].cycle);
+		describe("actual  ", t, t->cycle - refBase);
+		freeReference();
+		TraceDiverged = 1;
+		TraceEnabled = 0; // keep the lead-up in the ring
+		return;
+	}
+	if (refPos == TRACE_SYNC)
+		LogInfo("[FREEINTV] Trace: reference lined up at cycle %u\n", (unsigned int) refBase);
+	if (++refPos == refCount)
+	{
+		LogInfo("[FREEINTV] Trace: all %u reference instructions matched\n", (unsigned int) refCount);
+		freeReference();
+	}
+}
+
+void TraceInstruction(unsigned int opcode)
+{
+	struct traceRecord *t = &ring[head];
+	int i;
+
+	for (i = 0; i < 8; i++)
+		t->R[i] = (uint16_t) R[i];
+	t->opcode = (uint16_t) opcode;
+	t->operand[0] = (uint16_t) MemoryPeek(R[7] + 1);
+	t->operand[1] = (uint16_t) MemoryPeek(R[7] + 2);
+	t->flags = (Flag_Sign ? TRACE_S : 0) | (Flag_Zero ? TRACE_Z : 0) |
+		(Flag_Overflow ? TRACE_O : 0) | (Flag_Carry ? TRACE_C : 0) |
+		(Flag_InteruptEnable ? TRACE_I : 0) | (Flag_DoubleByteData ? TRACE_D : 0) |
+		(SR1 > 0 ? TRACE_Q : 0);
+	t->ticks = 0; // a bad opcode or HLT never reaches TraceTicks
+	t->cycle = (uint32_t) cycles;
+
+	last = t;
+	head = (head + 1) & (TRACE_RECORDS - 1);
+	if (count < TRACE_RECORDS)
+		count++;
+
+	if (ref != NULL)
+		verify(t);
+}
+
+void TraceTicks(int ticks)
+{
+	if (last == NULL)
+		return;
+	last->ticks = (uint8_t) ticks;
+	cycles += ticks;
+}
+
+static const char *opcodeName(unsigned int opcode)
+{
+	if (opcode >= 0x400 || Nmemonic[opcode] == NULL)
+		return "???";
+	return Nmemonic[opcode];
+}
+
+// the layout of the old CP1610Tick debug printf
+static void writeNative(FILE *fp, const struct traceRecord *t)
+{
+	fprintf(fp, "%04x:[%03x%c %04x %04x %04x %04x %04x %04x %04x %s %c%c%c%c%c%c\n",
+		t->R[7], t->opcode, t->opcode > 0x03ff ? 'X' : ']',
+		t->R[0], t->R[1], t->R[2], t->R[3], t->R[4], t->R[5], t->R[6],
+		opcodeName(t->opcode),
+		t->flags & TRACE_S ? 'S' : '-',
+		t->flags & TRACE_C ? 'C' : '-',
+		t->flags & TRACE_O ? 'O' : '-',
+		t->flags & TRACE_Z ? 'Z' : '-',
+		t->flags & TRACE_I ? 'I' : '-',
+		t->flags & TRACE_D ? 'D' : '-');
+}
+
+static const char *branchName[16] = {
+	"B", "BC", "BOV", "BPL", "BEQ", "BLT", "BLE", "BUSC",
+	"NOPP", "BNC", "BNOV", "BMI", "BNEQ", "BGE", "BGT", "BESC"
+};
+static const char *shiftName[8] = { "SWAP", "SLL", "RLC", "SLLC", "SLR", "SAR", "RRC", "SARC" };
+static const char *regName[8] = { "INCR", "DECR", "COMR", "NEGR", "ADCR", NULL, NULL, NULL };
+static const char *movName[6] = { "MOVR", "ADDR", "SUBR", "CMPR", "ANDR", "XORR" };
+static const char *memName[8] = { NULL, "MVO", "MVI", "ADD", "SUB", "CMP", "AND", "XOR" };
+static const char *impliedName[8] = { "HLT", "SDBD", "EIS", "DIS", NULL, "TCI", "CLRC", "SETC" };
+
+// as1600 syntax, decoded as in cp1610.c
+static void disassemble(char *out, size_t size, const struct traceRecord *t)
+{
+	unsigned int op = t->opcode, w1 = t->operand[0], w2 = t->operand[1];
+
+	if (op >= 0x400)
+		snprintf(out, size, "???");
+	else if (op < 0x008 && op != 0x004)
+		snprintf(out, size, "%s", impliedName[op]);
+	else if (op == 0x004) // J/JSR: 0000:0000:0100 bbaa:aaaa:aaff 00aa:aaaa:aaaa
+	{
+		static const char *ff[4] = { "", "E", "D", "" };
+		unsigned int reg = (w1 >> 8) & 3;
+		unsigned int adr = (((w1 >> 2) & 0x3F) << 10) | (w2 & 0x3FF);
+		if (reg == 3)
+			snprintf(out, size, "J%s $%04X", ff[w1 & 3], adr);
+		else
+			snprintf(out, size, "JSR%s R%u,$%04X", ff[w1 & 3], reg + 4, adr);
+	}
+	else if (op < 0x030)
+		snprintf(out, size, "%s R%u", regName[(op >> 3) - 1], op & 7);
+	else if (op < 0x034)
+		snprintf(out, size, "GSWD R%u", op & 3);
+	else if (op < 0x036)
+		snprintf(out, size, "NOP");
+	else if (op < 0x038)
+		snprintf(out, size, "SIN");
+	else if (op < 0x040)
+		snprintf(out, size, "RSWD R%u", op & 7);
+	else if (op < 0x080)
+	{
+		if (op & 4)
+			snprintf(out, size, "%s R%u,2", shiftName[(op >> 3) & 7], op & 3);
+		else
+			snprintf(out, size, "%s R%u", shiftName[(op >> 3) & 7], op & 3);
+	}
+	else if (op < 0x200)
+		snprintf(out, size, "%s R%u,R%u", movName[(op >> 6) - 2], (op >> 3) & 7, op & 7);
+	else if (op < 0x240) // Bcc: 0000:0010:00de:nccc, offset in the next word
+	{
+		unsigned int target = (op & 0x20) ? t->R[7] + 2 - w1 - 1 : t->R[7] + 2 + w1;
+		if (op & 0x10)
+			snprintf(out, size, "BEXT %u,$%04X", op & 0xF, target & 0xFFFF);
+		else
+			snprintf(out, size, "%s $%04X", branchName[op & 0xF], target & 0xFFFF);
+	}
+	else
+	{
+		const char *name = memName[(op >> 6) & 7];
+		unsigned int m = (op >> 3) & 7, r = op & 7;
+		unsigned int imm = (t->flags & TRACE_D) ? (w1 & 0xFF) | ((w2 & 0xFF) << 8) : w1;
+
+		if (op < 0x280) // MVO Rs,...
+		{
+			if (m == 0)
+				snprintf(out, size, "MVO R%u,$%04X", r, w1);
+			else if (m == 6)
+				snprintf(out, size, "PSHR R%u", r);
+			else
+				snprintf(out, size, "MVO@ R%u,R%u", r, m);
+		}
+		else if (m == 0)
+			snprintf(out, size, "%s $%04X,R%u", name, w1, r);
+		else if (m == 6 && op < 0x2C0)
+			snprintf(out, size, "PULR R%u", r);
+		else if (m == 7)
+			snprintf(out, size, "%sI #$%04X,R%u", name, imm, r);
+		else
+			snprintf(out, size, "%s@ R%u,R%u", name, m, r);
+	}
+}
+
+// jzIntv's debugger trace: registers, SZOCID, interruptible, SR1,
+// disassembly, cycle
+static void writeJzintv(FILE *fp, const struct traceRecord *t)
+{
+	char text[32];
+
+	disassemble(text, sizeof(text), t);
+	fprintf(fp, " %04X %04X %04X %04X %04X %04X %04X %04X %c%c%c%c%c%c%c%c  %-24s %u\n",
+		t->R[0], t->R[1], t->R[2], t->R[3], t->R[4], t->R[5], t->R[6], t->R[7],
+		t->flags & TRACE_S ? 'S' : '-',
+		t->flags & TRACE_Z ? 'Z' : '-',
+		t->flags & TRACE_O ? 'O' : '-',
+		t->flags & TRACE_C ? 'C' : '-',
+		t->flags & TRACE_I ? 'I' : '-',
+		t->flags & TRACE_D ? 'D' : '-',
+		t->opcode < 0x400 && Interuptable[t->opcode] ? 'i' : '-',
+		t->flags & TRACE_Q ? 'q' : '-',
+		text, (unsigned int) t->cycle);
+}
+
+static void writeTrace(const char *path, void (*line)(FILE *, const struct traceRecord *))
+{
+	uint32_t i, first = (head - count) & (TRACE_RECORDS - 1);
+	FILE *fp = fopen(path, "w");
+
+	if (fp == NULL)
+	{
+		LogError("[FREEINTV] Trace: can't write %s\n", path);
+		return;
+	}
+	for (i = 0; i < count; i++)
+		line(fp, &ring[(first + i) & (TRACE_RECORDS - 1)]);
+	fclose(fp);
+	LogInfo("[FREEINTV] Trace: wrote %u instructions to %s\n", (unsigned int) count, path);
+}
+
+void TraceDump(const char *romPath, const char *outDir)
+{
+	char base[256], name[300], out[1024];
+
+	if (ring == NULL || count == 0)
+		return;
+
+	if (romPath != NULL && romPath[0] != '\0')
+		fill_pathname_base_noext(base, romPath, sizeof(base));
+	else
+		strcpy(base, "FreeIntv");
+
+	snprintf(name, sizeof(name), "%s.trace.txt", base);
+	fill_pathname_join(out, outDir, name, sizeof(out));
+	writeTrace(out, writeNative);
+
+	snprintf(name, sizeof(name), "%s.jzintv.txt", base);
+	fill_pathname_join(out, outDir, name, sizeof(out));
+	writeTrace(out, writeJzintv);
+}
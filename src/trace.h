@@ -0,0 +1,77 @@
+#ifndef TRACE_H
+#define TRACE_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// CP1610 execution trace: while enabled, CP1610Tick packs the machine
+// state before each instruction into a ring of the last TRACE_RECORDS
+// instructions.  Nothing is formatted while the game runs; TraceDump
+// writes the ring out afterwards in the FreeIntv register dump format
+// and in jzIntv's debugger format, so the two emulators can be diffed.
+//
+// TraceVerifyStart also records, but checks each instruction against a
+// reference trace in the jzIntv format (from jzIntv, or from an earlier
+// build of FreeIntv).  Only the registers, the flags and the cycle count
+// at the end of each line are read, so the disassembly in between may be
+// in either emulator's syntax.  Checking starts at the first instruction whose
+// registers and flags equal the reference's first line, and cycles are
+// compared relative to that point, so a reference may begin anywhere.
+// A busy loop can pass through that state more than once, so a mismatch
+// within the first TRACE_SYNC instructions just restarts the search;
+// after that the first mismatch is logged and sets TraceDiverged.
+
+#include <stdint.h>
+
+#define TRACE_RECORDS 65536 // must be a power of two
+#define TRACE_SYNC 4096
+
+// flags
+#define TRACE_S 0x01 // sign
+#define TRACE_Z 0x02 // zero
+#define TRACE_O 0x04 // overflow
+#define TRACE_C 0x08 // carry
+#define TRACE_I 0x10 // interrupts enabled
+#define TRACE_D 0x20 // SDBD
+#define TRACE_Q 0x40 // interrupt request pending (SR1)
+
+struct traceRecord
+{
+	uint32_t cycle; // CPU cycles before this instruction
+	uint16_t R[8];  // R7 is the address of the opcode
+	uint16_t opcode;
+	uint16_t operand[2]; // the two words after the opcode, for disassembly
+	uint8_t flags;
+	uint8_t ticks;  // cycles used, including an interrupt taken after it
+};
+
+extern int TraceEnabled;
+extern int TraceDiverged;
+
+int TraceStart(void); // clear the ring and start recording, 0 if out of memory
+
+int TraceVerifyStart(const char *refPath); // start recording and checking, 0 if the reference can't be read
+
+void TraceInstruction(unsigned int opcode); // before each instruction
+
+void TraceTicks(int ticks); // after it
+
+void TraceDump(const char *romPath, const char *outDir); // write <rom>.trace.txt and <rom>.jzintv.txt
+
+void TraceStop(void); // stop recording and free the ring
+
+#endif
@@ -0,0 +1,453 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include "libretro.h"
+#include "cp1610.h"
+#include "memory.h"
+#include "intv.h"
+#include "stic.h"
+#include "osd.h"
+#include "trace.h"
+#include "log.h"
+#include "miniexec.h"
+#include "file/file_path.h"
+
+// CP1610 checks linked straight against the core: seeded random vectors
+// for every opcode, hashed and compared with cpu_vectors.txt; a few
+// known answers (SDBD, the interrupt window, the rotates through carry);
+// and a replay of the first REF_INSTRUCTIONS of 4-Tris, booted on the
+// stand-in EXEC, against a reference trace through TraceVerifyStart.
+//
+//   cpu_test [-r] cpu_vectors.txt 4-tris.ref.txt 4-tris.bin
+//
+// -r writes both files from this build instead of checking against
+// them.  Only do that for a change meant to alter what the CPU does,
+// and say why in the commit.
+
+#define VECTORS 64 // per opcode
+#define CODE 0x5000 // cart ROM, so the instruction can't overwrite itself
+#define REF_FRAMES 8
+#define REF_INSTRUCTIONS 8192
+
+static int quiet = 0;
+static int refMatched = 0;
+
+static void logPrintf(enum retro_log_level level, const char *fmt, ...)
+{
+	char text[512];
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintf(text, sizeof(text), fmt, ap);
+	va_end(ap);
+	if (strstr(text, "Trace: all ") != NULL)
+		refMatched = 1;
+	if ((level >= RETRO_LOG_WARN && !quiet) || getenv("FREEINTV_TEST_VERBOSE") != NULL)
+		fputs(text, stderr);
+}
+
+// xorshift64*, reseeded per opcode so that one opcode's vectors don't
+// depend on any other's
+static uint64_t rng;
+
+static unsigned int random16(void)
+{
+	rng ^= rng >> 12;
+	rng ^= rng << 25;
+	rng ^= rng >> 27;
+	return (unsigned int) ((rng * 0x2545F4914F6CDD1DULL) >> 48);
+}
+
+// pointers stay in 16-bit system RAM, away from the STIC, PSG and ports
+static unsigned int ramAddress(void)
+{
+	return 0x0200 + random16() % 0x160;
+}
+
+static uint64_t mix(uint64_t hash, unsigned int value)
+{
+	int i;
+	for (i = 0; i < 4; i++)
+	{
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static uint64_t hashState(uint64_t hash, int ticks)
+{
+	struct CP1610serialized cpu;
+	int i;
+
+	CP1610Serialize(&cpu);
+	for (i = 0; i < 8; i++)
+		hash = mix(hash, cpu.R[i]);
+	hash = mix(hash, cpu.Flag_Sign | cpu.Flag_Zero << 1 | cpu.Flag_Overflow << 2 | cpu.Flag_Carry << 3 |
+		cpu.Flag_InteruptEnable << 4 | cpu.Flag_DoubleByteData << 5);
+	hash = mix(hash, SR1);
+	hash = mix(hash, ticks);
+	for (i = 0x0200; i < 0x0360; i++)
+		hash = mix(hash, Memory[i]);
+	return hash;
+}
+
+static uint64_t runOpcode(unsigned int opcode)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	int i, v;
+
+	rng = 0x9E3779B97F4A7C15ULL * (opcode + 1);
+	for (v = 0; v < VECTORS; v++)
+	{
+		struct CP1610serialized cpu;
+		unsigned int m = (opcode >> 3) & 7;
+
+		cpu.Flag_Sign = random16() & 1;
+		cpu.Flag_Zero = random16() & 1;
+		cpu.Flag_Overflow = random16() & 1;
+		cpu.Flag_Carry = random16() & 1;
+		cpu.Flag_InteruptEnable = random16() & 1;
+		cpu.Flag_DoubleByteData = random16() & 1;
+		for (i = 0; i < 6; i++)
+			cpu.R[i] = random16();
+		cpu.R[6] = 0x02F0 + random16() % 0x60; // room to push and pull
+		cpu.R[7] = CODE;
+		SR1 = random16() & 1;
+
+		Memory[CODE] = opcode;
+		Memory[CODE + 1] = random16();
+		Memory[CODE + 2] = random16();
+		if (opcode >= 0x240 && m == 0)
+			Memory[CODE + 1] = ramAddress();
+		else if (opcode >= 0x240 && m < 6)
+			cpu.R[m] = ramAddress();
+
+		CP1610Unserialize(&cpu);
+		MemoryCheckpoint();
+		hash = hashState(hash, CP1610Tick(0));
+		MemoryRestore();
+	}
+	return hash;
+}
+
+static const char *mnemonic(unsigned int opcode, int *length)
+{
+	*length = (int) strcspn(Nmemonic[opcode], " ");
+	return Nmemonic[opcode];
+}
+
+static int checkVectors(const char *path, int record)
+{
+	static uint64_t expected[0x400];
+	static int have[0x400];
+	char line[128];
+	unsigned int opcode, failed = 0;
+	unsigned long long hash;
+	FILE *fp;
+	int length;
+
+	if (!record)
+	{
+		if ((fp = fopen(path, "r")) == NULL)
+		{
+			printf("FAIL can't read %s\n", path);
+			return 0;
+		}
+		while (fgets(line, sizeof(line), fp) != NULL)
+		{
+			if (sscanf(line, "%x %*s %llx", &opcode, &hash) == 2 && opcode < 0x400)
+			{
+				expected[opcode] = hash;
+				have[opcode] = 1;
+			}
+		}
+		fclose(fp);
+	}
+	else if ((fp = fopen(path, "w")) == NULL)
+	{
+		printf("FAIL can't write %s\n", path);
+		return 0;
+	}
+	else
+		fprintf(fp, "# opcode, mnemonic, hash of %d random vectors; see cpu_test.c\n", VECTORS);
+
+	quiet = 1; // HLT and friends complain
+	for (opcode = 0; opcode < 0x400; opcode++)
+	{
+		const char *name = mnemonic(opcode, &length);
+		uint64_t got = runOpcode(opcode);
+
+		LogFlush();
+		if (record)
+			fprintf(fp, "%03X %-5.*s %016llX\n", opcode, length, name, (unsigned long long) got);
+		else if (!have[opcode] || expected[opcode] != got)
+		{
+			printf("FAIL %03X %.*s: vectors differ\n", opcode, length, name);
+			failed++;
+		}
+	}
+	quiet = 0;
+
+	if (record)
+	{
+		fclose(fp);
+		printf("wrote %s\n", path);
+		return 1;
+	}
+	if (failed == 0)
+		printf("ok   %d vectors for each of 1024 opcodes\n", VECTORS);
+	return failed == 0;
+}
+
+struct known
+{
+	const char *name;
+	uint16_t code[4];
+	int steps;      // instructions to run
+	int flags, sr1; // in: TRACE_ flags, SR1
+	uint16_t R[8];  // in, R7 is always CODE
+	int outFlags, outSR1, ticks;
+	uint16_t outR[8];
+	uint16_t adr, val; // a word expected in memory afterwards, adr 0 for none
+};
+
+static const struct known knowns[] =
+{
+	{ "SDBD MVII", { 0x0001, 0x02B8, 0x0034, 0x0012 }, 2,
+		0, 0, { 0, 0, 0, 0, 0, 0, 0x2F1 },
+		0, 0, 14, { 0x1234, 0, 0, 0, 0, 0, 0x2F1, CODE + 4 } },
+	{ "SDBD MVI@ R4", { 0x0001, 0x02A1 }, 2,
+		0, 0, { 0, 0, 0, 0, 0x300, 0, 0x2F1 },
+		0, 0, 14, { 0, 0xCDAB, 0, 0, 0x302, 0, 0x2F1, CODE + 2 } },
+	{ "SDBD MVI@ R1", { 0x0001, 0x0288 | (1 << 3) | 2 }, 2,
+		0, 0, { 0, 0x300, 0, 0, 0, 0, 0x2F1 },
+		0, 0, 14, { 0, 0x300, 0xABAB, 0, 0, 0, 0x2F1, CODE + 2 } },
+	{ "interrupt after NOP", { 0x0034 }, 1,
+		TRACE_I, 1, { 0, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_I, 0, 18, { 0, 0, 0, 0, 0, 0, 0x2F2, 0x1004 }, 0x2F1, CODE + 1 },
+	{ "interrupt held off by SDBD", { 0x0001 }, 1,
+		TRACE_I, 1, { 0, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_I | TRACE_D, 1, 4, { 0, 0, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "interrupt held off by EIS", { 0x0002 }, 1,
+		0, 1, { 0, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_I, 1, 4, { 0, 0, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "interrupt after SDBD MVII", { 0x0001, 0x02B8, 0x0034, 0x0012 }, 2,
+		TRACE_I, 1, { 0, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_I, 0, 26, { 0x1234, 0, 0, 0, 0, 0, 0x2F2, 0x1004 }, 0x2F1, CODE + 4 },
+	{ "no interrupt when disabled", { 0x0034 }, 1,
+		0, 1, { 0, 0, 0, 0, 0, 0, 0x2F1 },
+		0, 1, 6, { 0, 0, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "SLLC R0", { 0x0058 }, 1,
+		0, 0, { 0x8001, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_C, 0, 6, { 0x0002, 0, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "SLLC R0,2", { 0x005C }, 1,
+		0, 0, { 0x4001, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_O, 0, 8, { 0x0004, 0, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "SLLC R0,2 sign", { 0x005C }, 1,
+		TRACE_O | TRACE_C, 0, { 0x2000, 0, 0, 0, 0, 0, 0x2F1 },
+		TRACE_S, 0, 8, { 0x8000, 0, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "RRC R1", { 0x0071 }, 1,
+		TRACE_C, 0, { 0, 0x0001, 0, 0, 0, 0, 0x2F1 },
+		TRACE_C, 0, 6, { 0, 0x8000, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "RRC R1,2", { 0x0075 }, 1,
+		TRACE_C, 0, { 0, 0x0003, 0, 0, 0, 0, 0x2F1 },
+		TRACE_O | TRACE_C, 0, 8, { 0, 0x4000, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+	{ "RRC R1,2 sign from bit 7", { 0x0075 }, 1,
+		TRACE_O, 0, { 0, 0x0200, 0, 0, 0, 0, 0x2F1 },
+		TRACE_S, 0, 8, { 0, 0x8080, 0, 0, 0, 0, 0x2F1, CODE + 1 } },
+};
+
+static int flagsOf(const struct CP1610serialized *cpu)
+{
+	return (cpu->Flag_Sign ? TRACE_S : 0) | (cpu->Flag_Zero ? TRACE_Z : 0) |
+		(cpu->Flag_Overflow ? TRACE_O : 0) | (cpu->Flag_Carry ? TRACE_C : 0) |
+		(cpu->Flag_InteruptEnable ? TRACE_I : 0) | (cpu->Flag_DoubleByteData ? TRACE_D : 0);
+}
+
+static int checkKnown(const struct known *k)
+{
+	struct CP1610serialized cpu;
+	int i, ticks = 0, pass;
+
+	memset(&cpu, 0, sizeof(cpu));
+	for (i = 0; i < 7; i++)
+		cpu.R[i] = k->R[i];
+	cpu.R[7] = CODE;
+	cpu.Flag_Sign = (k->flags & TRACE_S) != 0;
+	cpu.Flag_Zero = (k->flags & TRACE_Z) != 0;
+	cpu.Flag_Overflow = (k->flags & TRACE_O) != 0;
+	cpu.Flag_Carry = (k->flags & TRACE_C) != 0;
+	cpu.Flag_InteruptEnable = (k->flags & TRACE_I) != 0;
+	cpu.Flag_DoubleByteData = (k->flags & TRACE_D) != 0;
+	SR1 = k->sr1;
+	for (i = 0; i < 4; i++)
+		Memory[CODE + i] = k->code[i];
+	Memory[0x300] = 0x12AB;
+	Memory[0x301] = 0x34CD;
+
+	CP1610Unserialize(&cpu);
+	MemoryCheckpoint();
+	for (i = 0; i < k->steps; i++)
+		ticks += CP1610Tick(0);
+	CP1610Serialize(&cpu);
+	pass = flagsOf(&cpu) == k->outFlags && SR1 == k->outSR1 &&
+		ticks == k->ticks && (k->adr == 0 || Memory[k->adr] == k->val);
+	for (i = 0; i < 8; i++)
+		pass &= cpu.R[i] == k->outR[i];
+	if (!pass)
+	{
+		printf("FAIL %s: R0-R7", k->name);
+		for (i = 0; i < 8; i++)
+			printf(" %04X", cpu.R[i]);
+		printf(" flags %02X SR1 %d ticks %d", flagsOf(&cpu), SR1, ticks);
+		if (k->adr != 0)
+			printf(" [%04X] %04X", k->adr, Memory[k->adr]);
+		printf("\n");
+	}
+	MemoryRestore();
+	return pass;
+}
+
+static int checkKnowns(void)
+{
+	int i, failed = 0, count = (int) (sizeof(knowns) / sizeof(knowns[0]));
+
+	for (i = 0; i < count; i++)
+		failed += !checkKnown(&knowns[i]);
+	if (failed == 0)
+		printf("ok   %d known answers\n", count);
+	return failed == 0;
+}
+
+static void bootCart(const char *rom)
+{
+	uint16_t exec[0x1000];
+	int i;
+
+	Init();
+	MiniExec(exec);
+	for (i = 0; i < 0x1000; i++)
+		Memory[0x1000 + i] = exec[i];
+	MemoryHashInvalidate();
+	LoadGame(rom);
+	Reset();
+}
+
+// keep the first REF_INSTRUCTIONS lines of a TraceDump
+static int recordReference(const char *rom, const char *refPath)
+{
+	char dir[] = "/tmp/freeintv-cpu-XXXXXX", base[256], path[300], line[256];
+	FILE *in, *out;
+	int i, lines = 0;
+
+	if (mkdtemp(dir) == NULL)
+		return 0;
+	bootCart(rom);
+	TraceStart();
+	for (i = 0; i < REF_FRAMES; i++)
+		Run();
+	TraceDump(rom, dir);
+	TraceStop();
+	LogFlush();
+
+	fill_pathname_base_noext(base, rom, sizeof(base));
+	snprintf(path, sizeof(path), "%s/%s.jzintv.txt", dir, base);
+	in = fopen(path, "r");
+	out = fopen(refPath, "w");
+	while (in != NULL && out != NULL && lines < REF_INSTRUCTIONS && fgets(line, sizeof(line), in) != NULL)
+	{
+		fputs(line, out);
+		lines++;
+	}
+	if (in != NULL)
+		fclose(in);
+	if (out != NULL)
+		fclose(out);
+	remove(path);
+	snprintf(path, sizeof(path), "%s/%s.trace.txt", dir, base);
+	remove(path);
+	rmdir(dir);
+
+	if (lines < REF_INSTRUCTIONS)
+	{
+		printf("FAIL only %d instructions traced for %s\n", lines, refPath);
+		return 0;
+	}
+	printf("wrote %s\n", refPath);
+	return 1;
+}
+
+static int checkReference(const char *rom, const char *refPath)
+{
+	int i;
+
+	bootCart(rom);
+	refMatched = 0;
+	if (!TraceVerifyStart(refPath))
+	{
+		printf("FAIL can't read %s\n", refPath);
+		return 0;
+	}
+	for (i = 0; i < REF_FRAMES && !TraceDiverged && !refMatched; i++)
+	{
+		Run();
+		LogFlush();
+	}
+	TraceStop();
+	LogFlush();
+
+	if (!refMatched)
+	{
+		printf("FAIL 4-Tris doesn't follow %s\n", refPath);
+		return 0;
+	}
+	printf("ok   4-Tris follows %s\n", refPath);
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	int record = argc > 1 && strcmp(argv[1], "-r") == 0;
+	int failed = 0;
+
+	if (argc != 4 + record)
+	{
+		fprintf(stderr, "usage: cpu_test [-r] cpu_vectors.txt 4-tris.ref.txt 4-tris.bin\n");
+		return 2;
+	}
+	argv += record;
+
+	LogInit(logPrintf);
+	OSD_setDisplay(frame, 352, 224);
+	Init();
+	Reset();
+
+	failed += !checkVectors(argv[1], record);
+	if (!record)
+		failed += !checkKnowns();
+	if (record)
+		failed += !recordReference(argv[3], argv[2]);
+	else
+		failed += !checkReference(argv[3], argv[2]);
+	return failed != 0;
+}
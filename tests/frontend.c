@@ -0,0 +1,298 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <unistd.h>
+#include "libretro.h"
+#include "frontend.h"
+#include "miniexec.h"
+
+#define MAX_OPTIONS 32
+
+static void *core = NULL;
+
+static void (*coreSetEnvironment)(retro_environment_t);
+static void (*coreSetVideoRefresh)(retro_video_refresh_t);
+static void (*coreSetAudioSample)(retro_audio_sample_t);
+static void (*coreSetAudioSampleBatch)(retro_audio_sample_batch_t);
+static void (*coreSetInputPoll)(retro_input_poll_t);
+static void (*coreSetInputState)(retro_input_state_t);
+static void (*coreInit)(void);
+static void (*coreDeinit)(void);
+static bool (*coreLoadGame)(const struct retro_game_info *);
+static void (*coreUnloadGame)(void);
+static void (*coreRun)(void);
+static size_t (*coreSerializeSize)(void);
+static bool (*coreSerialize)(void *, size_t);
+
+static struct { const char *key, *value; } options[MAX_OPTIONS];
+static int optionCount = 0;
+static const char *systemDir = "";
+static const char *saveDir = "";
+static retro_keyboard_event_t keyboard = NULL;
+static char scratch[64] = "";
+
+static void logPrintf(enum retro_log_level level, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (level < RETRO_LOG_WARN && getenv("FREEINTV_TEST_VERBOSE") == NULL)
+		return;
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+}
+
+static bool environment(unsigned cmd, void *data)
+{
+	int i;
+
+	switch (cmd)
+	{
+		case RETRO_ENVIRONMENT_GET_VARIABLE:
+		{
+			struct retro_variable *var = (struct retro_variable *) data;
+			for (i = 0; i < optionCount; i++)
+			{
+				if (strcmp(options[i].key, var->key) == 0)
+				{
+					var->value = options[i].value;
+					return true;
+				}
+			}
+			return false;
+		}
+		case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+			*(const char **) data = systemDir;
+			return true;
+		case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+			*(const char **) data = saveDir;
+			return true;
+		case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+			((struct retro_log_callback *) data)->log = logPrintf;
+			return true;
+		case RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK:
+			keyboard = ((const struct retro_keyboard_callback *) data)->callback;
+			return true;
+		case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+		case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+			return true;
+	}
+	return false;
+}
+
+static void videoRefresh(const void *data, unsigned width, unsigned height, size_t pitch) { }
+static void audioSample(int16_t left, int16_t right) { }
+static size_t audioSampleBatch(const int16_t *data, size_t frames) { return frames; }
+static void inputPoll(void) { }
+static int16_t inputState(unsigned port, unsigned device, unsigned index, unsigned id) { return 0; }
+
+#define BIND(var, name) if ((*(void **) &var = dlsym(core, name)) == NULL) { return 0; }
+
+int FrontendOpen(const char *corePath)
+{
+	if ((core = dlopen(corePath, RTLD_NOW | RTLD_LOCAL)) == NULL)
+	{
+		fprintf(stderr, "%s\n", dlerror());
+		return 0;
+	}
+	BIND(coreSetEnvironment, "retro_set_environment");
+	BIND(coreSetVideoRefresh, "retro_set_video_refresh");
+	BIND(coreSetAudioSample, "retro_set_audio_sample");
+	BIND(coreSetAudioSampleBatch, "retro_set_audio_sample_batch");
+	BIND(coreSetInputPoll, "retro_set_input_poll");
+	BIND(coreSetInputState, "retro_set_input_state");
+	BIND(coreInit, "retro_init");
+	BIND(coreDeinit, "retro_deinit");
+	BIND(coreLoadGame, "retro_load_game");
+	BIND(coreUnloadGame, "retro_unload_game");
+	BIND(coreRun, "retro_run");
+	BIND(coreSerializeSize, "retro_serialize_size");
+	BIND(coreSerialize, "retro_serialize");
+	return 1;
+}
+
+void FrontendClose(void)
+{
+	if (core != NULL)
+		dlclose(core);
+	core = NULL;
+}
+
+void FrontendOption(const char *key, const char *value)
+{
+	int i;
+
+	for (i = 0; i < optionCount; i++)
+	{
+		if (strcmp(options[i].key, key) == 0)
+		{
+			options[i].value = value;
+			return;
+		}
+	}
+	if (optionCount < MAX_OPTIONS)
+	{
+		options[optionCount].key = key;
+		options[optionCount].value = value;
+		optionCount++;
+	}
+}
+
+void FrontendFolders(const char *system, const char *save)
+{
+	systemDir = system;
+	saveDir = save;
+}
+
+int FrontendLoad(const char *romPath)
+{
+	struct retro_game_info info;
+
+	memset(&info, 0, sizeof(info));
+	info.path = romPath;
+	coreSetEnvironment(environment);
+	coreSetVideoRefresh(videoRefresh);
+	coreSetAudioSample(audioSample);
+	coreSetAudioSampleBatch(audioSampleBatch);
+	coreSetInputPoll(inputPoll);
+	coreSetInputState(inputState);
+	coreInit();
+	if (!coreLoadGame(&info))
+	{
+		coreDeinit();
+		return 0;
+	}
+	return 1;
+}
+
+void FrontendUnload(void)
+{
+	coreUnloadGame();
+	coreDeinit();
+	keyboard = NULL;
+}
+
+void FrontendRun(int frames)
+{
+	while (frames-- > 0)
+		coreRun();
+}
+
+void FrontendKey(unsigned keycode, int down)
+{
+	if (keyboard != NULL)
+		keyboard(down != 0, keycode, 0, 0);
+}
+
+size_t FrontendSave(void **data)
+{
+	size_t size = coreSerializeSize();
+
+	if ((*data = malloc(size)) == NULL)
+		return 0;
+	if (!coreSerialize(*data, size))
+	{
+		free(*data);
+		*data = NULL;
+		return 0;
+	}
+	return size;
+}
+
+const char *FrontendScratch(void)
+{
+	char path[128];
+	FILE *fp;
+
+	if (scratch[0] != '\0')
+		return scratch;
+	strcpy(scratch, "/tmp/freeintv-test-XXXXXX");
+	if (mkdtemp(scratch) == NULL)
+	{
+		scratch[0] = '\0';
+		return NULL;
+	}
+	snprintf(path, sizeof(path), "%s/exec.bin", scratch);
+	if (!MiniExecWrite(path))
+		return NULL;
+	snprintf(path, sizeof(path), "%s/grom.bin", scratch);
+	if ((fp = fopen(path, "wb")) == NULL)
+		return NULL;
+	fseek(fp, 0x7FF, SEEK_SET);
+	fputc(0, fp);
+	fclose(fp);
+	return scratch;
+}
+
+void FrontendRemoveScratch(void)
+{
+	char path[512];
+	struct dirent *entry;
+	DIR *dir;
+
+	if (scratch[0] == '\0' || (dir = opendir(scratch)) == NULL)
+		return;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (entry->d_name[0] == '.')
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", scratch, entry->d_name);
+		unlink(path);
+	}
+	closedir(dir);
+	rmdir(scratch);
+	scratch[0] = '\0';
+}
+
+int CopyFile(const char *from, const char *to)
+{
+	char buffer[4096];
+	size_t len;
+	FILE *in, *out;
+	int ok = 1;
+
+	if ((in = fopen(from, "rb")) == NULL)
+		return 0;
+	if ((out = fopen(to, "wb")) == NULL)
+	{
+		fclose(in);
+		return 0;
+	}
+	while ((len = fread(buffer, 1, sizeof(buffer), in)) > 0)
+		ok &= fwrite(buffer, 1, len, out) == len;
+	fclose(in);
+	fclose(out);
+	return ok;
+}
+
+int WriteText(const char *path, const char *text)
+{
+	FILE *fp = fopen(path, "w");
+	int ok;
+
+	if (fp == NULL)
+		return 0;
+	ok = fputs(text, fp) >= 0;
+	fclose(fp);
+	return ok;
+}
@@ -0,0 +1,55 @@
+#ifndef FRONTEND_H
+#define FRONTEND_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// Just enough of a libretro frontend to drive the core from the tests:
+// the core is loaded with dlopen, runs headless with no input, and gets
+// its options, system and save folders from here.
+
+#include <stddef.h>
+
+int FrontendOpen(const char *corePath); // 0 if the core can't be loaded
+
+void FrontendClose(void);
+
+void FrontendOption(const char *key, const char *value); // before FrontendLoad
+
+void FrontendFolders(const char *system, const char *save);
+
+int FrontendLoad(const char *romPath); // retro_init and retro_load_game
+
+void FrontendUnload(void); // retro_unload_game and retro_deinit
+
+void FrontendRun(int frames);
+
+void FrontendKey(unsigned keycode, int down); // RETROK_*
+
+size_t FrontendSave(void **data); // retro_serialize into a malloc'd buffer, 0 on failure
+
+// scratch folder holding a stand-in exec.bin and an empty grom.bin, so
+// carts that skip the EXEC run without the real BIOS
+const char *FrontendScratch(void);
+
+void FrontendRemoveScratch(void);
+
+int CopyFile(const char *from, const char *to);
+
+int WriteText(const char *path, const char *text);
+
+#endif
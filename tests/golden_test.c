@@ -0,0 +1,84 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "frontend.h"
+
+// Plays 4-tris.golden.txt, recorded beside this file, back through the
+// core with tools/freeintv-golden, using the scratch system folder from
+// frontend.c so the stand-in EXEC boots the cart as it did when it was
+// recorded.  With -r it records the file again instead, after a change
+// that is meant to alter the picture or sound:
+//
+//   golden_test [-r] freeintv-golden core.so rom
+
+#define GOLDEN_FRAMES "600"
+
+int main(int argc, char *argv[])
+{
+	const char *args[16];
+	int record = argc > 1 && strcmp(argv[1], "-r") == 0;
+	int n = 0, status = 2, wstatus;
+	pid_t pid;
+
+	if (argc - record != 4)
+	{
+		fprintf(stderr, "usage: golden_test [-r] freeintv-golden core.so rom\n");
+		return 1;
+	}
+	argv += record;
+	if (FrontendScratch() == NULL)
+		return 1;
+
+	args[n++] = argv[1];
+	if (record)
+	{
+		args[n++] = "-r";
+		args[n++] = "-n";
+		args[n++] = GOLDEN_FRAMES;
+	}
+	args[n++] = "-s";
+	args[n++] = FrontendScratch();
+	args[n++] = "-g";
+	args[n++] = ".";
+	args[n++] = argv[2];
+	args[n++] = argv[3];
+	args[n] = NULL;
+
+	fflush(stdout);
+	if ((pid = fork()) == 0)
+	{
+		execv(args[0], (char *const *) args);
+		perror(args[0]);
+		_exit(2);
+	}
+	if (pid > 0 && waitpid(pid, &wstatus, 0) == pid && WIFEXITED(wstatus))
+		status = WEXITSTATUS(wstatus);
+	FrontendRemoveScratch();
+
+	if (status != 0)
+	{
+		printf("FAIL golden frames %s\n", record ? "not recorded" : "differ from the recording");
+		return 1;
+	}
+	printf("ok   golden frames %s\n", record ? "recorded" : "match the recording");
+	return 0;
+}
@@ -0,0 +1,126 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include "memory.h"
+#include "jlp.h"
+#include "log.h"
+
+// Known answers for the JLP accelerator, driven through the memory bus
+// the way a game reaches it (see jlp.h for the register map).
+//
+//   jlp_test
+
+struct op
+{
+	const char *name;
+	int a, b;         // operands, b written second
+	int pair;         // $9F80 + 2 * pair
+	int low, high;    // expected $9F8E, $9F8F
+};
+
+static const struct op ops[] =
+{
+	{ "signed * signed",     0xFFFD, 0x0005, 0, 0xFFF1, 0xFFFF },
+	{ "signed * unsigned",   0xFFFD, 0xFFFF, 1, 0x0003, 0xFFFD },
+	{ "unsigned * signed",   0xFFFF, 0xFFFD, 2, 0x0003, 0xFFFD },
+	{ "unsigned * unsigned", 0xFFFF, 0xFFFF, 3, 0x0001, 0xFFFE },
+	{ "unsigned * unsigned", 300,    200,    3, 0xEA60, 0x0000 },
+	{ "signed / signed",     0xFFF9, 0x0002, 4, 0xFFFD, 0xFFFF },
+	{ "unsigned / unsigned", 0xFFF9, 0x0002, 5, 0x7FFC, 0x0001 },
+	{ "unsigned / 0",        1234,   0,      5, 0xFFFF, 1234 },
+};
+
+static int failed = 0;
+
+static void expect(const char *name, int adr, int want)
+{
+	int got = readMem(adr);
+
+	if (got != want)
+	{
+		printf("FAIL %s: $%04X reads %04X, expected %04X\n", name, adr, got, want);
+		failed++;
+	}
+}
+
+static void checkOps(void)
+{
+	int i, count = (int) (sizeof(ops) / sizeof(ops[0]));
+
+	for (i = 0; i < count; i++)
+	{
+		const struct op *o = &ops[i];
+		writeMem(0x9F80 + o->pair * 2, o->a);
+		writeMem(0x9F81 + o->pair * 2, o->b);
+		expect(o->name, 0x9F8E, o->low);
+		expect(o->name, 0x9F8F, o->high);
+		expect(o->name, 0x9F80 + o->pair * 2, o->a);
+	}
+
+	// only the second operand starts an operation
+	writeMem(0x9F86, 7);
+	expect("first operand alone", 0x9F8E, ops[count - 1].low);
+	writeMem(0x9F87, 6);
+	expect("second operand", 0x9F8E, 42);
+}
+
+static void checkCrcRandom(void)
+{
+	writeMem(0x9FFD, 0);
+	writeMem(0x9FFC, 0x1234);
+	writeMem(0x9FFC, 0xABCD);
+	expect("CRC-16", 0x9FFD, 0x1C36);
+
+	JLPReset();
+	expect("random 1", 0x9FFE, 0x10A5);
+	expect("random 2", 0x9FFE, 0x544A);
+	expect("random 3", 0x9FFE, 0x488E);
+}
+
+static void checkEnable(void)
+{
+	// mode 2: plain RAM until the game writes the enable code
+	MemoryInit();
+	JLPInit(2, 0);
+	writeMem(0x9F86, 3);
+	writeMem(0x9F87, 4);
+	writeMem(0x9F8E, 0x5555);
+	expect("accelerator off", 0x9F8E, 0x5555);
+	writeMem(0x8033, 0x4A5A);
+	writeMem(0x9F86, 3);
+	writeMem(0x9F87, 4);
+	expect("accelerator on", 0x9F8E, 12);
+	writeMem(0x8034, 0x6A7A);
+	expect("accelerator off again", 0x9F8E, 0x5555);
+}
+
+int main(void)
+{
+	LogInit(NULL);
+	MemoryInit();
+	JLPInit(1, 0);
+
+	checkOps();
+	checkCrcRandom();
+	checkEnable();
+	LogFlush();
+
+	if (failed == 0)
+		printf("ok   JLP accelerator, CRC and random registers\n");
+	return failed != 0;
+}
@@ -0,0 +1,89 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "miniexec.h"
+
+static const uint16_t reset[] =
+{
+	// $1000
+	0x0004, 0x0310, 0x0030, // J     $1030
+};
+
+static const uint16_t interrupt[] =
+{
+	// $1004
+	0x0270, 0x0271, 0x0272, // PSHR  R0, R1, R2
+	0x0273, 0x0274, 0x0275, // PSHR  R3, R4, R5
+	0x0280, 0x0100,         // MVI   $100, R0
+	0x0281, 0x0101,         // MVI   $101, R1
+	0x0041,                 // SWAP  R1
+	0x01C8,                 // XORR  R1, R0
+	0x02BD, 0x1020,         // MVII  #$1020, R5
+	0x0087,                 // MOVR  R0, PC
+};
+
+static const uint16_t isrReturn[] =
+{
+	// $1020
+	0x02B5, 0x02B4, 0x02B3, // PULR  R5, R4, R3
+	0x02B2, 0x02B1, 0x02B0, // PULR  R2, R1, R0
+	0x02B7,                 // PULR  PC
+};
+
+static const uint16_t boot[] =
+{
+	// $1030: start the cart
+	0x02BE, 0x02F1,         // MVII  #$2F1, R6
+	0x0280, 0x5004,         // MVI   $5004, R0
+	0x0281, 0x5005,         // MVI   $5005, R1
+	0x03B8, 0x00FF,         // ANDI  #$FF, R0
+	0x03B9, 0x00FF,         // ANDI  #$FF, R1
+	0x0041,                 // SWAP  R1
+	0x01C8,                 // XORR  R1, R0
+	0x0087,                 // MOVR  R0, PC
+};
+
+void MiniExec(uint16_t words[0x1000])
+{
+	memset(words, 0, 0x1000 * sizeof(uint16_t));
+	memcpy(&words[0x000], reset, sizeof(reset));
+	memcpy(&words[0x004], interrupt, sizeof(interrupt));
+	memcpy(&words[0x020], isrReturn, sizeof(isrReturn));
+	memcpy(&words[0x030], boot, sizeof(boot));
+}
+
+int MiniExecWrite(const char *path)
+{
+	uint16_t words[0x1000];
+	unsigned char rom[0x2000];
+	FILE *fp;
+	int i;
+
+	MiniExec(words);
+	for (i = 0; i < 0x1000; i++)
+	{
+		rom[i * 2] = words[i] >> 8;
+		rom[i * 2 + 1] = words[i] & 0xFF;
+	}
+	if ((fp = fopen(path, "wb")) == NULL)
+		return 0;
+	i = fwrite(rom, sizeof(rom), 1, fp) == 1;
+	fclose(fp);
+	return i;
+}
@@ -0,0 +1,33 @@
+#ifndef MINIEXEC_H
+#define MINIEXEC_H
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+// A stand-in for the EXEC BIOS, which can't ship with the tests.  It
+// only does what carts that skip the EXEC (4-Tris among them) need:
+// reset jumps to the start address in the cart header at $5004/$5005,
+// and the interrupt entry at $1004 saves R0-R5, calls the ISR vector
+// at $100/$101 and returns.
+
+#include <stdint.h>
+
+void MiniExec(uint16_t words[0x1000]); // image for $1000-$1FFF
+
+int MiniExecWrite(const char *path); // as exec.bin (big-endian words), 0 on failure
+
+#endif
@@ -0,0 +1,94 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libretro.h"
+#include "frontend.h"
+
+// In-core rewind must land exactly on an earlier frame, including on
+// carts whose memory map grows when they load (JLP flash, ECS RAM,
+// .cfg RAM), where the state is bigger than at retro_init.
+
+#define REWIND_FRAMES 30
+
+struct cart
+{
+	const char *name;
+	const char *cfg;
+};
+
+static const struct cart carts[] =
+{
+	{ "plain", "[mapping]\n$0000-$1FFF = $5000\n" },
+	{ "jlpflash", "[mapping]\n$0000-$1FFF = $5000\n[vars]\njlp = 1\njlpflash = 8\n" },
+	{ "ecs", "[mapping]\n$0000-$1FFF = $5000\n[vars]\necs = 1\n" },
+	{ "memattr", "[mapping]\n$0000-$1FFF = $5000\n[memattr]\n$8000-$9FFF = RAM 16\n" },
+};
+
+static int rewindCart(const char *rom, const struct cart *cart)
+{
+	char path[256], cfgPath[256];
+	void *before, *after;
+	size_t size, afterSize;
+	int pass;
+
+	snprintf(path, sizeof(path), "%s/%s.bin", FrontendScratch(), cart->name);
+	snprintf(cfgPath, sizeof(cfgPath), "%s/%s.cfg", FrontendScratch(), cart->name);
+	if (!CopyFile(rom, path) || !WriteText(cfgPath, cart->cfg) || !FrontendLoad(path))
+	{
+		printf("FAIL %s: can't load\n", cart->name);
+		return 0;
+	}
+
+	FrontendRun(60);
+	size = FrontendSave(&before);
+	FrontendRun(REWIND_FRAMES - 1);
+	FrontendKey(RETROK_BACKSPACE, 1);
+	FrontendRun(REWIND_FRAMES);
+	FrontendKey(RETROK_BACKSPACE, 0);
+	afterSize = FrontendSave(&after);
+
+	pass = size != 0 && size == afterSize && memcmp(before, after, size) == 0;
+	printf("%s rewind %d frames on %s\n", pass ? "ok  " : "FAIL", REWIND_FRAMES, cart->name);
+
+	free(before);
+	free(after);
+	FrontendUnload();
+	return pass;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *corePath = argc > 1 ? argv[1] : "../FreeIntvTSOverlay_libretro.so";
+	const char *rom = argc > 2 ? argv[2] : "../open-content/4-Tris/4-tris.bin";
+	int i, failed = 0;
+
+	if (!FrontendOpen(corePath) || FrontendScratch() == NULL)
+		return 1;
+	FrontendFolders(FrontendScratch(), FrontendScratch());
+	FrontendOption("rewind_buffer", "8");
+	FrontendOption("boot_cache", "disabled");
+
+	for (i = 0; i < (int) (sizeof(carts) / sizeof(carts[0])); i++)
+		failed += !rewindCart(rom, &carts[i]);
+
+	FrontendRemoveScratch();
+	FrontendClose();
+	return failed != 0;
+}
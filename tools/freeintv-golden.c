@@ -0,0 +1,370 @@
+/*
+	This file is part of FreeIntv.
+
+	FreeIntv is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	FreeIntv is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License along
+	with FreeIntv; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/wait.h>
+#include "libretro.h"
+
+// Golden frame runner: plays each ROM's <game>.golden.txt back through
+// the core, one ROM per process, and fails at the first frame whose
+// picture or sound differs from the recording (see src/golden.h).  The
+// core replays the recorded controller bytes itself; this only counts
+// the differing frames it logs.  The core's save folder is a scratch
+// folder per process, so nothing but the recording is written next to
+// the ROMs.
+//
+//   freeintv-golden [options] core.so rom...
+//
+//   -r         record <game>.golden.txt instead of checking it
+//   -n frames  frames to record (default 3600)
+//   -t frames  differing frames allowed per ROM (default 0)
+//   -j jobs    ROMs run at once (default 1)
+//   -s dir     system folder with exec.bin and grom.bin (default .)
+//   -g dir     folder for the .golden.txt files (default beside each ROM)
+//   -v         show the core's log
+//
+// Exits 0 when every ROM matches or was recorded, 1 when one differs and
+// 2 when one couldn't be run.  No more ROMs are started after a failure.
+
+#define RUN_OK      0
+#define RUN_DIFFERS 1
+#define RUN_ERROR   2
+
+static int recording = 0;
+static int recordFrames = 3600;
+static int tolerance = 0;
+static int verbose = 0;
+static const char *systemDir = ".";
+static const char *goldenDir = NULL;
+
+// per ROM, in its own process
+static char saveDir[] = "/tmp/freeintv-golden-XXXXXX";
+static int started = 0;    // the core opened the recording
+static int differing = 0;  // frames that differ
+static int lastFrame = -1; // last frame counted, a frame can differ in both
+static int firstFrame = -1;
+static char firstWhat[16];
+
+static void logPrintf(enum retro_log_level level, const char *fmt, ...)
+{
+	char text[1024], what[16];
+	unsigned int frame;
+	const char *golden;
+	va_list ap;
+
+	va_start(ap, fmt);
+	vsnprintf(text, sizeof(text), fmt, ap);
+	va_end(ap);
+	if (verbose)
+		fputs(text, stderr);
+
+	if ((golden = strstr(text, "Golden: ")) == NULL)
+		return;
+	golden += strlen("Golden: ");
+	if (strncmp(golden, "verifying against ", 18) == 0 || strncmp(golden, "recording to ", 13) == 0)
+		started = 1;
+	else if (sscanf(golden, "frame %u differs in %15s", &frame, what) == 2 && (int) frame != lastFrame)
+	{
+		lastFrame = (int) frame;
+		if (differing++ == 0)
+		{
+			firstFrame = (int) frame;
+			strcpy(firstWhat, what);
+		}
+	}
+	else if (!verbose && !started && level >= RETRO_LOG_ERROR)
+		fputs(text, stderr); // can't read or write the recording
+}
+
+static bool environment(unsigned cmd, void *data)
+{
+	switch (cmd)
+	{
+		case RETRO_ENVIRONMENT_GET_VARIABLE:
+		{
+			struct retro_variable *var = (struct retro_variable *) data;
+			if (strcmp(var->key, "golden") == 0)
+				var->value = recording ? "record" : "verify";
+			else if (strcmp(var->key, "boot_cache") == 0)
+				var->value = "disabled";
+			else
+				return false;
+			return true;
+		}
+		case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+			*(const char **) data = systemDir;
+			return true;
+		case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+			*(const char **) data = saveDir;
+			return true;
+		case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+			((struct retro_log_callback *) data)->log = logPrintf;
+			return true;
+		case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+		case RETRO_ENVIRONMENT_GET_INPUT_BITMASKS:
+			return true;
+	}
+	return false;
+}
+
+static void videoRefresh(const void *data, unsigned width, unsigned height, size_t pitch) { }
+static void audioSample(int16_t left, int16_t right) { }
+static size_t audioSampleBatch(const int16_t *data, size_t frames) { return frames; }
+static void inputPoll(void) { }
+static int16_t inputState(unsigned port, unsigned device, unsigned index, unsigned id) { return 0; }
+
+// <game>.golden.txt in the golden folder, and in the scratch folder
+// where the core reads and writes it
+static void goldenPaths(const char *rom, char *path, char *scratch, size_t size)
+{
+	const char *name = strrchr(rom, '/');
+	const char *dot;
+	int length;
+
+	name = name ? name + 1 : rom;
+	dot = strrchr(name, '.');
+	length = dot ? (int) (dot - name) : (int) strlen(name);
+	if (goldenDir != NULL)
+		snprintf(path, size, "%s/%.*s.golden.txt", goldenDir, length, name);
+	else
+		snprintf(path, size, "%.*s%.*s.golden.txt", (int) (name - rom), rom, length, name);
+	snprintf(scratch, size, "%s/%.*s.golden.txt", saveDir, length, name);
+}
+
+static int copyFile(const char *from, const char *to)
+{
+	char buffer[65536];
+	FILE *in = fopen(from, "rb"), *out = NULL;
+	size_t n;
+	int ok = in != NULL && (out = fopen(to, "wb")) != NULL;
+
+	while (ok && (n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+		ok = fwrite(buffer, 1, n, out) == n;
+	if (in != NULL)
+		fclose(in);
+	if (out != NULL && fclose(out) != 0)
+		ok = 0;
+	return ok;
+}
+
+static void removeScratch(void)
+{
+	char path[2048];
+	struct dirent *entry;
+	DIR *dir = opendir(saveDir);
+
+	while (dir != NULL && (entry = readdir(dir)) != NULL)
+	{
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", saveDir, entry->d_name);
+		remove(path);
+	}
+	if (dir != NULL)
+		closedir(dir);
+	rmdir(saveDir);
+}
+
+static int countFrames(const char *path)
+{
+	char line[128];
+	int frames = 0;
+	FILE *fp = fopen(path, "r");
+
+	if (fp == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		if (line[0] != '#' && line[0] != '\n')
+			frames++;
+	}
+	fclose(fp);
+	return frames;
+}
+
+#define BIND(var, name) if ((*(void **) &var = dlsym(core, name)) == NULL) { fprintf(stderr, "%s: no %s\n", corePath, name); return RUN_ERROR; }
+
+static int runCore(const char *corePath, const char *rom, const char *path, const char *scratch)
+{
+	void (*setEnvironment)(retro_environment_t);
+	void (*setVideoRefresh)(retro_video_refresh_t);
+	void (*setAudioSample)(retro_audio_sample_t);
+	void (*setAudioSampleBatch)(retro_audio_sample_batch_t);
+	void (*setInputPoll)(retro_input_poll_t);
+	void (*setInputState)(retro_input_state_t);
+	void (*init)(void);
+	void (*deinit)(void);
+	bool (*loadGame)(const struct retro_game_info *);
+	void (*unloadGame)(void);
+	void (*run)(void);
+	struct retro_game_info info;
+	int frames, frame;
+	void *core;
+
+	frames = recording ? recordFrames : countFrames(path);
+	if (frames < 0 || (!recording && !copyFile(path, scratch)))
+	{
+		printf("FAIL %s: can't read %s\n", rom, path);
+		return RUN_ERROR;
+	}
+
+	if ((core = dlopen(corePath, RTLD_NOW | RTLD_LOCAL)) == NULL)
+	{
+		fprintf(stderr, "%s\n", dlerror());
+		return RUN_ERROR;
+	}
+	BIND(setEnvironment, "retro_set_environment");
+	BIND(setVideoRefresh, "retro_set_video_refresh");
+	BIND(setAudioSample, "retro_set_audio_sample");
+	BIND(setAudioSampleBatch, "retro_set_audio_sample_batch");
+	BIND(setInputPoll, "retro_set_input_poll");
+	BIND(setInputState, "retro_set_input_state");
+	BIND(init, "retro_init");
+	BIND(deinit, "retro_deinit");
+	BIND(loadGame, "retro_load_game");
+	BIND(unloadGame, "retro_unload_game");
+	BIND(run, "retro_run");
+
+	setEnvironment(environment);
+	setVideoRefresh(videoRefresh);
+	setAudioSample(audioSample);
+	setAudioSampleBatch(audioSampleBatch);
+	setInputPoll(inputPoll);
+	setInputState(inputState);
+	init();
+	memset(&info, 0, sizeof(info));
+	info.path = rom;
+	if (!loadGame(&info) || !started)
+	{
+		printf("FAIL %s: can't %s %s\n", rom, recording ? "record" : "check", path);
+		return RUN_ERROR;
+	}
+
+	for (frame = 0; frame < frames; frame++)
+	{
+		run();
+		if (differing > tolerance)
+		{
+			printf("FAIL %s: frame %d differs in %s", rom, firstFrame, firstWhat);
+			if (tolerance > 0)
+				printf(", %d frames differ by frame %d", differing, lastFrame);
+			printf("\n");
+			return RUN_DIFFERS; // no need to unload, the process ends here
+		}
+	}
+	unloadGame();
+	deinit();
+	dlclose(core);
+
+	if (recording && !copyFile(scratch, path))
+	{
+		printf("FAIL %s: can't write %s\n", rom, path);
+		return RUN_ERROR;
+	}
+	if (recording)
+		printf("ok   %s: recorded %d frames to %s\n", rom, frames, path);
+	else if (differing > 0)
+		printf("ok   %s: %d of %d frames differ, within %d\n", rom, differing, frames, tolerance);
+	else
+		printf("ok   %s: %d frames match\n", rom, frames);
+	return RUN_OK;
+}
+
+static int runRom(const char *corePath, const char *rom)
+{
+	char path[2048], scratch[2048];
+	int result;
+
+	if (mkdtemp(saveDir) == NULL)
+	{
+		perror(saveDir);
+		return RUN_ERROR;
+	}
+	goldenPaths(rom, path, scratch, sizeof(path));
+	result = runCore(corePath, rom, path, scratch);
+	removeScratch();
+	return result;
+}
+
+static int usage(void)
+{
+	fprintf(stderr, "usage: freeintv-golden [-r] [-n frames] [-t frames] [-j jobs] [-s system_dir] [-g golden_dir] [-v] core.so rom...\n");
+	return RUN_ERROR;
+}
+
+int main(int argc, char *argv[])
+{
+	int jobs = 1, running = 0, worst = RUN_OK;
+	int opt, i;
+
+	while ((opt = getopt(argc, argv, "rn:t:j:s:g:v")) != -1)
+	{
+		switch (opt)
+		{
+			case 'r': recording = 1; break;
+			case 'n': recordFrames = atoi(optarg); break;
+			case 't': tolerance = atoi(optarg); break;
+			case 'j': jobs = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+			case 's': systemDir = optarg; break;
+			case 'g': goldenDir = optarg; break;
+			case 'v': verbose = 1; break;
+			default: return usage();
+		}
+	}
+	if (argc - optind < 2)
+		return usage();
+
+	for (i = optind + 1; i <= argc; i++)
+	{
+		int status;
+
+		// wait for a free slot, or for everything at the end
+		while (running > 0 && (running >= jobs || i == argc || worst != RUN_OK))
+		{
+			if (wait(&status) < 0)
+				break;
+			running--;
+			status = WIFEXITED(status) ? WEXITSTATUS(status) : RUN_ERROR;
+			if (status > worst)
+				worst = status;
+		}
+		if (i == argc || worst != RUN_OK)
+			break;
+
+		fflush(stdout);
+		switch (fork())
+		{
+			case -1:
+				perror("fork");
+				worst = RUN_ERROR;
+				break;
+			case 0:
+				status = runRom(argv[optind], argv[i]);
+				fflush(stdout);
+				_exit(status);
+			default:
+				running++;
+		}
+	}
+	return worst;
+}
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# mkcartdb.py - generate src/cartdb.h from the TOSEC DATs in metadata/
+#
+# Every game dump listed in the DATs becomes a (crc32, size) entry.  The
+# memory map for an entry is taken from the fingerprints[] table in
+# src/cart.c by matching titles, so the DATs and the existing database stay
+# the single sources of truth.  Bad/alternate dumps ([a], [h], [o], ...) and
+# titles that can't be matched get map -1, which tells LoadCart() to fall
+# back to the fingerprint scan.  Dumps tagged (ECS) in the DATs get
+# CARTDB_ECS so the ECS is attached for them.
+#
+# usage: python3 tools/mkcartdb.py   (run from the repository root)
+#
+
+import glob
+import html
+import re
+import sys
+
+DATS = 'metadata/Mattel Intellivision - Games (*).dat'
+CART = 'src/cart.c'
+OUT = 'src/cartdb.h'
+BUCKETS = 512  # power of two, at least twice the number of entries
+
+# DAT titles that are spelled differently in fingerprints[]
+ALIASES = {
+    'adventureadanddcloudymountain': 'adventure',
+    'advanceddungeonsanddragonstreasureoftarmin': 'advanceddanddtreasureoftarmin',
+    'riverraidv1': 'riverraid',
+    'robotrubblev2': 'robotrubble',
+    'tagalongtoddv313': 'tagalongtodd',
+}
+
+def norm(title):
+    title = html.unescape(title).lower().replace('&', 'and')
+    title = re.sub(r'^the\s+|,\s*the$', '', title.strip())
+    return re.sub(r'[^a-z0-9]', '', title)
+
+def dat_title(name):
+    return name.split(' (')[0]
+
+def fingerprint_maps():
+    maps = {}
+    text = open(CART).read()
+    body = text[text.index('fingerprints[]'):]
+    body = body[:body.index('};')]
+    for m in re.finditer(r'^\s*(\d+),\s*(\d+)\s*,?\s*//\s*(.*)$', body, re.M):
+        key = norm(re.split(r' \(|\s+by\s+', m.group(3))[0])
+        maps.setdefault(key, set()).add(int(m.group(2)))
+    return maps
+
+def main():
+    maps = fingerprint_maps()
+    entries = []
+    unmatched = []
+    for dat in sorted(glob.glob(DATS)):
+        for m in re.finditer(r'<rom name="([^"]*)" size="(\d+)" crc="([0-9a-f]{8})"', open(dat).read()):
+            name, size, crc = html.unescape(m.group(1)), int(m.group(2)), int(m.group(3), 16)
+            name = re.sub(r'\.(bin|int|itv|rom)$', '', name)
+            key = norm(dat_title(name))
+            key = ALIASES.get(key, key)
+            method = -1
+            if '[' not in name and len(maps.get(key, ())) == 1:
+                method = next(iter(maps[key]))
+            elif '[' not in name:
+                unmatched.append(name)
+            flags = 'CARTDB_ECS' if '(ECS)' in name else '0'
+            entries.append((crc, size, method, flags, name))
+
+    if len(entries) * 2 > BUCKETS:
+        sys.exit('mkcartdb: raise BUCKETS')
+
+    table = [-1] * BUCKETS
+    for i, (crc, size, method, flags, name) in enumerate(entries):
+        h = crc & (BUCKETS - 1)
+        while table[h] >= 0:
+            h = (h + 1) & (BUCKETS - 1)
+        table[h] = i
+
+    with open(OUT, 'w', newline='\r\n') as f:
+        f.write('/* Generated by tools/mkcartdb.py from the TOSEC DATs in metadata/ - do not edit */\n\n')
+        f.write('#define CARTDB_BUCKETS %d\n\n' % BUCKETS)
+        f.write('static const struct cartdbEntry cartdb[] =\n{\n')
+        for crc, size, method, flags, name in entries:
+            f.write('{0x%08x, %6d, %2d, %s, "%s"},\n' % (crc, size, method, flags, name.replace('\\', '\\\\').replace('"', '\\"')))
+        f.write('};\n\n')
+        f.write('static const short cartdbIndex[CARTDB_BUCKETS] =\n{\n')
+        for i in range(0, BUCKETS, 16):
+            f.write(', '.join('%3d' % v for v in table[i:i + 16]) + ',\n')
+        f.write('};\n')
+
+    print('%d entries, %d with a memory map' % (len(entries), sum(e[2] >= 0 for e in entries)))
+    for name in unmatched:
+        print('  no map: ' + name)
+
+if __name__ == '__main__':
+    main()